@@ -0,0 +1,200 @@
+// 图查找索引基准测试
+// 生成一个 5000 个节点的合成图，对比线性查找和索引查找在以下场景中的耗时：
+//   界面帧：每个端口查询是否有连线，每条连线查找两端端口
+//   执行：每个节点的每个输入查找连线和上游端口并读取值
+// 用法：graph-index-benchmark [节点数量] [重复次数]
+//
+// 实测结果（5000 个节点，9998 条连线，重复 3 次，Linux x86_64 单核，g++ -O2）：
+//   索引重建                 3.2 ~ 3.8 ms
+//   界面帧查找    线性 305 ~ 313 ms    索引 0.96 ~ 1.05 ms    约 300 倍
+//   执行输入查找  线性 149 ~ 169 ms    索引 0.53 ~ 0.68 ms    约 250 ~ 280 倍
+// 这组数字由去掉 OpenCV 和界面依赖、逐字复制 graph_index 查找代码的独立程序测得，
+// “调度器执行全图”一项需要完整构建，上表没有包含
+
+#include "base_nodes.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+// 建立索引之前 Graph 的线性查找实现，作为对比基准
+namespace linear
+{
+    Pin *FindPin(Graph &graph, ed::PinId id)
+    {
+        if (!id)
+            return nullptr;
+
+        for (auto &node : graph.Nodes)
+        {
+            for (auto &pin : node.Inputs)
+                if (pin.ID == id)
+                    return &pin;
+
+            for (auto &pin : node.Outputs)
+                if (pin.ID == id)
+                    return &pin;
+        }
+
+        return nullptr;
+    }
+
+    bool IsPinLinked(Graph &graph, ed::PinId id)
+    {
+        if (!id)
+            return false;
+
+        for (auto &link : graph.Links)
+            if (link.StartPinID == id || link.EndPinID == id)
+                return true;
+
+        return false;
+    }
+
+    Link *FindPinLink(Graph &graph, ed::PinId id)
+    {
+        if (!id)
+            return nullptr;
+
+        for (auto &link : graph.Links)
+            if (link.StartPinID == id || link.EndPinID == id)
+                return &link;
+
+        return nullptr;
+    }
+} // namespace linear
+
+struct indexed
+{
+    static Pin *FindPin(Graph &graph, ed::PinId id) { return graph.FindPin(id); }
+    static bool IsPinLinked(Graph &graph, ed::PinId id) { return graph.IsPinLinked(id); }
+    static Link *FindPinLink(Graph &graph, ed::PinId id) { return graph.FindPinLink(id); }
+};
+
+struct linear_lookup
+{
+    static Pin *FindPin(Graph &graph, ed::PinId id) { return linear::FindPin(graph, id); }
+    static bool IsPinLinked(Graph &graph, ed::PinId id) { return linear::IsPinLinked(graph, id); }
+    static Link *FindPinLink(Graph &graph, ed::PinId id) { return linear::FindPinLink(graph, id); }
+};
+
+// 每个节点两个输入一个输出，输入分别连接到前一个节点和下标一半的节点
+static void build_synthetic_graph(Graph &graph, int node_count)
+{
+    graph.env.graph = &graph;
+    graph.env.app = nullptr;
+    graph.Nodes.reserve(node_count);
+    for (int i = 0; i < node_count; i++)
+    {
+        graph.Nodes.emplace_back(graph.get_next_id(), "累加");
+        auto &node = graph.Nodes.back();
+        node.Type = NodeType::Simple;
+        node.Inputs.emplace_back(graph.get_next_id(), "a", PinType::Int, 0);
+        node.Inputs.emplace_back(graph.get_next_id(), "b", PinType::Int, 0);
+        node.Outputs.emplace_back(graph.get_next_id(), "结果", PinType::Int, 0);
+        node.OnExecute = [](Graph *graph, Node *node)
+        {
+            int a = 0;
+            get_value(graph, node->Inputs[0], a);
+            int b = 0;
+            get_value(graph, node->Inputs[1], b);
+            node->Outputs[0].SetValue((a + b + 1) % 1000);
+            return ExecuteResult::Success();
+        };
+    }
+    graph.build_nodes();
+    graph.Links.reserve(node_count * 2);
+    for (int i = 1; i < node_count; i++)
+    {
+        graph.add_link(Link(graph.get_next_id(), graph.Nodes[i - 1].Outputs[0].ID, graph.Nodes[i].Inputs[0].ID));
+        graph.add_link(Link(graph.get_next_id(), graph.Nodes[i / 2].Outputs[0].ID, graph.Nodes[i].Inputs[1].ID));
+    }
+}
+
+// 模拟一帧界面绘制中的查找
+template <typename Lookup>
+static size_t simulate_frame(Graph &graph)
+{
+    size_t linked = 0;
+    for (auto &node : graph.Nodes)
+    {
+        for (auto &input : node.Inputs)
+            linked += Lookup::IsPinLinked(graph, input.ID);
+        for (auto &output : node.Outputs)
+            linked += Lookup::IsPinLinked(graph, output.ID);
+    }
+    for (auto &link : graph.Links)
+        linked += Lookup::FindPin(graph, link.StartPinID) && Lookup::FindPin(graph, link.EndPinID);
+    return linked;
+}
+
+// 模拟按拓扑顺序执行一次全图时 get_value 中的查找
+template <typename Lookup>
+static size_t simulate_execute(Graph &graph)
+{
+    size_t sum = 0;
+    for (auto &node : graph.Nodes)
+    {
+        int values[2] = {0, 0};
+        for (size_t i = 0; i < node.Inputs.size(); i++)
+        {
+            auto link = Lookup::FindPinLink(graph, node.Inputs[i].ID);
+            auto pin = link ? Lookup::FindPin(graph, link->StartPinID) : &node.Inputs[i];
+            if (pin)
+                pin->GetValue(values[i]);
+        }
+        node.Outputs[0].SetValue((values[0] + values[1] + 1) % 1000);
+        sum += values[0];
+    }
+    return sum;
+}
+
+template <typename F>
+static double measure_ms(int repeat, F &&func)
+{
+    size_t sink = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; i++)
+        sink += func();
+    auto end = std::chrono::steady_clock::now();
+    if (sink == static_cast<size_t>(-1))
+        printf("\n");
+    return std::chrono::duration<double, std::milli>(end - begin).count() / repeat;
+}
+
+int main(int argc, char *argv[])
+{
+    int node_count = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int repeat = argc > 2 ? std::atoi(argv[2]) : 3;
+
+    Graph graph;
+    build_synthetic_graph(graph, node_count);
+    printf("节点: %zu 连线: %zu 重复: %d\n", graph.Nodes.size(), graph.Links.size(), repeat);
+
+    double rebuild_ms = measure_ms(1, [&graph]()
+                                   {
+                                       graph.invalidate_index();
+                                       return static_cast<size_t>(graph.FindNode(graph.Nodes.front().ID) != nullptr); });
+
+    double frame_linear = measure_ms(repeat, [&graph]()
+                                     { return simulate_frame<linear_lookup>(graph); });
+    double frame_indexed = measure_ms(repeat, [&graph]()
+                                      { return simulate_frame<indexed>(graph); });
+    double execute_linear = measure_ms(repeat, [&graph]()
+                                       { return simulate_execute<linear_lookup>(graph); });
+    double execute_indexed = measure_ms(repeat, [&graph]()
+                                        { return simulate_execute<indexed>(graph); });
+
+    // 使用调度器实际执行全图（索引查找）
+    graph.env.incremental = false;
+    double execute_scheduler = measure_ms(repeat, [&graph]()
+                                          {
+                                              graph.env.ExecuteNodes();
+                                              return graph.env.executed_count.load(); });
+
+    printf("索引重建: %.3f ms\n", rebuild_ms);
+    printf("界面帧查找   线性: %10.3f ms  索引: %8.3f ms  加速: %.1fx\n", frame_linear, frame_indexed, frame_linear / frame_indexed);
+    printf("执行输入查找 线性: %10.3f ms  索引: %8.3f ms  加速: %.1fx\n", execute_linear, execute_indexed, execute_linear / execute_indexed);
+    printf("调度器执行全图（索引）: %.3f ms, 工作线程: %zu\n", execute_scheduler, graph.env.get_worker_count());
+    return 0;
+}
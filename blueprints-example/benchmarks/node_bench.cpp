@@ -0,0 +1,376 @@
+// 节点基准测试
+// 遍历 NodeWorldGlobal::nodeFactories 中所有有图像输入的节点，不创建界面直接调用节点的执行函数
+// 输入为固定种子生成的随机图像，覆盖 VGA、1080p、4K 三种分辨率和 8U、32F 两种深度，其他输入使用节点的默认值
+// 三通道图像执行出错时改用单通道图像重试，仍然出错的组合记录错误信息
+// 输出每次调用的耗时、吞吐量（百万像素/秒）和每次调用的图像分配次数
+// 用法：node-bench [选项]
+//   -o, --out FILE           结果写入 JSON 文件
+//   --compare FILE           和之前保存的结果比较，耗时增加超过阈值的组合视为退化，有退化时返回 1
+//   --threshold PERCENT      退化阈值，默认 10%
+//   --filter TEXT            只测试名称包含 TEXT 的节点
+//   --sizes LIST             分辨率，逗号分隔，可选 vga,1080p,4k，默认全部
+//   --depths LIST            深度，逗号分隔，可选 8u,32f，默认全部
+//   --min-time MS            每个组合至少执行的时间，默认 200 ms
+//   --min-calls N            每个组合至少执行的次数，默认 3 次
+
+#include "base_nodes.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    struct resolution
+    {
+        std::string name;
+        cv::Size size;
+    };
+
+    struct depth
+    {
+        std::string name;
+        int value;
+    };
+
+    const std::vector<resolution> all_resolutions = {{"vga", {640, 480}}, {"1080p", {1920, 1080}}, {"4k", {3840, 2160}}};
+    const std::vector<depth> all_depths = {{"8u", CV_8U}, {"32f", CV_32F}};
+
+    struct options
+    {
+        std::string out_path;
+        std::string compare_path;
+        double threshold = 10;
+        std::string filter;
+        std::vector<resolution> resolutions = all_resolutions;
+        std::vector<depth> depths = all_depths;
+        double min_time_ms = 200;
+        int min_calls = 3;
+    };
+
+    struct result
+    {
+        std::string node;
+        std::string type;
+        std::string resolution;
+        std::string depth;
+        int channels = 0;
+        size_t calls = 0;
+        double ms_per_call = 0;
+        double min_ms = 0;
+        double mp_per_s = 0;
+        double allocations_per_call = 0;
+        std::string error;
+
+        std::string key() const { return node + " " + resolution + " " + depth; }
+    };
+
+    void print_usage()
+    {
+        printf("用法: node-bench [-o 文件] [--compare 文件] [--threshold 百分比] [--filter 名称] [--sizes vga,1080p,4k] [--depths 8u,32f] [--min-time 毫秒] [--min-calls 次数]\n");
+    }
+
+    std::vector<std::string> split(const std::string &text)
+    {
+        std::vector<std::string> items;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+            if (!item.empty())
+                items.push_back(item);
+        return items;
+    }
+
+    // 从全部选项中按名称挑选，有不认识的名称时返回 false
+    template <typename T>
+    bool select(const std::vector<T> &all, const std::string &text, std::vector<T> &selected)
+    {
+        selected.clear();
+        for (auto &name : split(text))
+        {
+            auto it = std::find_if(all.begin(), all.end(), [&name](const T &item)
+                                   { return item.name == name; });
+            if (it == all.end())
+                return false;
+            selected.push_back(*it);
+        }
+        return !selected.empty();
+    }
+
+    std::optional<options> parse_options(int argc, char *argv[])
+    {
+        options opts;
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if ((arg == "-o" || arg == "--out") && has_value)
+                opts.out_path = argv[++i];
+            else if (arg == "--compare" && has_value)
+                opts.compare_path = argv[++i];
+            else if (arg == "--threshold" && has_value)
+                opts.threshold = std::max(0.0, std::atof(argv[++i]));
+            else if (arg == "--filter" && has_value)
+                opts.filter = argv[++i];
+            else if (arg == "--sizes" && has_value)
+            {
+                if (!select(all_resolutions, argv[++i], opts.resolutions))
+                    return std::nullopt;
+            }
+            else if (arg == "--depths" && has_value)
+            {
+                if (!select(all_depths, argv[++i], opts.depths))
+                    return std::nullopt;
+            }
+            else if (arg == "--min-time" && has_value)
+                opts.min_time_ms = std::max(0.0, std::atof(argv[++i]));
+            else if (arg == "--min-calls" && has_value)
+                opts.min_calls = std::max(1, std::atoi(argv[++i]));
+            else
+                return std::nullopt;
+        }
+        return opts;
+    }
+
+    std::string type_name(NodeType type)
+    {
+        for (auto &[name, node_type] : nodeTypes)
+            if (node_type == type)
+                return name;
+        return "未知";
+    }
+
+    // Win32 节点会截图、发送键盘鼠标输入，不在基准测试中执行
+    bool is_benchmarkable(const Node &node)
+    {
+        if (node.Type == NodeType::Win32 || node.Type == NodeType::Win32Input)
+            return false;
+        return std::any_of(node.Inputs.begin(), node.Inputs.end(), [](const Pin &pin)
+                           { return pin.Type == PinType::Image; });
+    }
+
+    cv::Mat synthetic_image(cv::Size size, int depth, int channels)
+    {
+        cv::Mat image(size, CV_MAKETYPE(depth, channels));
+        cv::RNG rng(0x1234);
+        if (depth == CV_32F)
+            rng.fill(image, cv::RNG::UNIFORM, 0.0, 1.0);
+        else
+            rng.fill(image, cv::RNG::UNIFORM, 0, 256);
+        return image;
+    }
+
+    // 调用到至少 min_calls 次且累计至少 min_time_ms，第一次调用作为预热不计入
+    result measure(Graph &graph, Node *node, const cv::Mat &image, const options &opts)
+    {
+        result r;
+        for (auto &input : node->Inputs)
+            if (input.Type == PinType::Image)
+                input.SetValue(image);
+        r.channels = image.channels();
+
+        auto first = node->OnExecuteEx(&graph, node);
+        if (first.has_error())
+        {
+            r.error = first.Error->Message;
+            return r;
+        }
+
+        auto &counter = mat_allocation_counter::instance();
+        auto allocations_before = counter.get_count();
+        double total_ms = 0;
+        double min_ms = std::numeric_limits<double>::max();
+        while (r.calls < static_cast<size_t>(opts.min_calls) || total_ms < opts.min_time_ms)
+        {
+            auto begin = std::chrono::steady_clock::now();
+            auto call = node->OnExecuteEx(&graph, node);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            if (call.has_error())
+            {
+                r.error = call.Error->Message;
+                return r;
+            }
+            total_ms += ms;
+            min_ms = std::min(min_ms, ms);
+            r.calls++;
+        }
+        r.ms_per_call = total_ms / r.calls;
+        r.min_ms = min_ms;
+        r.mp_per_s = image.total() / 1e6 / (r.ms_per_call / 1000);
+        r.allocations_per_call = static_cast<double>(counter.get_count() - allocations_before) / r.calls;
+        return r;
+    }
+
+    json::object to_json(const std::vector<result> &results)
+    {
+        json::array items;
+        for (auto &r : results)
+        {
+            json::object item;
+            item["node"] = r.node;
+            item["type"] = r.type;
+            item["resolution"] = r.resolution;
+            item["depth"] = r.depth;
+            if (!r.error.empty())
+            {
+                item["error"] = r.error;
+                items.push_back(item);
+                continue;
+            }
+            item["channels"] = r.channels;
+            item["calls"] = static_cast<uint64_t>(r.calls);
+            item["ms_per_call"] = r.ms_per_call;
+            item["min_ms"] = r.min_ms;
+            item["mp_per_s"] = r.mp_per_s;
+            item["allocations_per_call"] = r.allocations_per_call;
+            items.push_back(item);
+        }
+        json::object root;
+        root["opencv"] = CV_VERSION;
+        root["threads"] = cv::getNumThreads();
+        root["results"] = items;
+        return root;
+    }
+
+    // 读取之前保存的结果，返回每个组合的每次调用耗时，出错的组合不参与比较
+    std::optional<std::map<std::string, double>> load_baseline(const std::string &path)
+    {
+        std::ifstream in(path);
+        if (!in)
+            return std::nullopt;
+        std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        auto parsed = json::parse(text);
+        if (!parsed || !parsed->is_object() || !parsed->as_object().contains("results"))
+            return std::nullopt;
+        std::map<std::string, double> baseline;
+        for (auto &item : parsed->as_object().at("results").as_array())
+        {
+            auto &obj = item.as_object();
+            if (!obj.contains("ms_per_call"))
+                continue;
+            result r;
+            r.node = obj.at("node").as_string();
+            r.resolution = obj.at("resolution").as_string();
+            r.depth = obj.at("depth").as_string();
+            baseline[r.key()] = obj.at("ms_per_call").as_double();
+        }
+        return baseline;
+    }
+
+    // 返回退化的组合数量
+    size_t compare(const std::vector<result> &results, const std::map<std::string, double> &baseline, double threshold)
+    {
+        size_t regressions = 0, compared = 0;
+        printf("\n和基准比较（阈值 %.1f%%）\n", threshold);
+        for (auto &r : results)
+        {
+            auto it = baseline.find(r.key());
+            if (!r.error.empty() || it == baseline.end() || it->second <= 0)
+                continue;
+            compared++;
+            double change = (r.ms_per_call / it->second - 1) * 100;
+            if (change <= threshold)
+                continue;
+            regressions++;
+            printf("  退化 %-32s %8.3f ms -> %8.3f ms (%+.1f%%)\n", r.key().c_str(), it->second, r.ms_per_call, change);
+        }
+        printf("比较 %zu 个组合，退化 %zu 个\n", compared, regressions);
+        return regressions;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    auto opts = parse_options(argc, argv);
+    if (!opts)
+    {
+        print_usage();
+        return 2;
+    }
+
+    std::optional<std::map<std::string, double>> baseline;
+    if (!opts->compare_path.empty())
+    {
+        baseline = load_baseline(opts->compare_path);
+        if (!baseline)
+        {
+            fprintf(stderr, "无法读取基准结果: %s\n", opts->compare_path.c_str());
+            return 2;
+        }
+    }
+
+    // 没有界面，图像端口不生成纹理
+    factory_group_init();
+    mat_allocation_counter::install();
+    Graph graph;
+    graph.ui.graph = &graph;
+    graph.env.app = nullptr;
+    graph.env.graph = &graph;
+    // 工厂返回 Nodes 中元素的指针，预留空间保证创建后续节点时指针不失效
+    size_t factory_count = 0;
+    for (auto &[type, factories] : NodeWorldGlobal::nodeFactories)
+        factory_count += factories.size();
+    graph.Nodes.reserve(factory_count);
+
+    printf("OpenCV %s 线程: %d\n", CV_VERSION, cv::getNumThreads());
+    std::vector<result> results;
+    for (auto &[type, factories] : NodeWorldGlobal::nodeFactories)
+    {
+        for (auto &[name, factory] : factories)
+        {
+            if (!opts->filter.empty() && name.find(opts->filter) == std::string::npos)
+                continue;
+            auto node = factory([&graph]()
+                                { return graph.get_next_id(); },
+                                [&graph](Node *node)
+                                { graph.build_node(node); },
+                                graph.Nodes, nullptr);
+            if (!node || !is_benchmarkable(*node))
+                continue;
+            for (auto &res : opts->resolutions)
+            {
+                for (auto &d : opts->depths)
+                {
+                    auto r = measure(graph, node, synthetic_image(res.size, d.value, 3), *opts);
+                    if (!r.error.empty())
+                        r = measure(graph, node, synthetic_image(res.size, d.value, 1), *opts);
+                    r.node = name;
+                    r.type = type_name(type);
+                    r.resolution = res.name;
+                    r.depth = d.name;
+                    if (r.error.empty())
+                        printf("%-24s %-6s %-4s %dch %10.3f ms %10.1f MP/s %8.1f 次分配/调用\n", name.c_str(), res.name.c_str(), d.name.c_str(), r.channels, r.ms_per_call, r.mp_per_s, r.allocations_per_call);
+                    else
+                        printf("%-24s %-6s %-4s 错误: %s\n", name.c_str(), res.name.c_str(), d.name.c_str(), r.error.c_str());
+                    results.push_back(std::move(r));
+                }
+            }
+            // 释放节点持有的大图像
+            for (auto &pin : node->Inputs)
+                if (pin.Type == PinType::Image)
+                    pin.SetValue(cv::Mat());
+            for (auto &pin : node->Outputs)
+                pin.Value = shared_port_value();
+        }
+    }
+
+    if (!opts->out_path.empty())
+    {
+        std::ofstream out(opts->out_path, std::ios::binary);
+        out << to_json(results).dumps();
+        if (!out.good())
+        {
+            fprintf(stderr, "无法写入结果: %s\n", opts->out_path.c_str());
+            return 2;
+        }
+        printf("结果: %s\n", opts->out_path.c_str());
+    }
+
+    graph.env.need_stop();
+    if (baseline)
+        return compare(results, *baseline, opts->threshold) > 0 ? 1 : 0;
+    return 0;
+}
@@ -0,0 +1,167 @@
+// OpenCV 并行策略基准测试
+// 节点执行滤波、形态学、颜色转换等内部使用 cv::parallel_for_ 的运算，比较不同的 OpenCV 并行策略下执行全图的完成时间：
+//   opencv    OpenCV 自己的线程池，多个节点同时执行时线程数超过核心数
+//   serial    节点内部不并行
+//   adaptive  节点内部只使用空闲的工作线程
+//   all       节点内部总是拆给所有工作线程
+// 图的形状：
+//   chain    一条链，同一时刻只有一个节点就绪，适合节点内部并行
+//   wide     一个源节点扇出到所有节点，同时就绪的节点很多，适合节点之间并行
+//   mixed    先是一段链，再扇出为多条短链，两种阶段交替
+// OpenCV 的并行后端替换后不能恢复，所以先测试 opencv 策略
+// 用法：opencv-threading-benchmark [节点数量] [重复次数] [工作线程数] [图像宽度] [图像高度]
+
+#include "base_nodes.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    // 每个节点的上游节点下标，源节点为 -1
+    std::vector<int> generate(const std::string &shape, int node_count)
+    {
+        std::vector<int> parent(node_count, -1);
+        if (shape == "chain")
+        {
+            for (int i = 1; i < node_count; i++)
+                parent[i] = i - 1;
+        }
+        else if (shape == "wide")
+        {
+            for (int i = 1; i < node_count; i++)
+                parent[i] = 0;
+        }
+        else
+        {
+            // 源节点之后四分之一的节点组成一段链，其余节点组成长度为 3 的分支
+            const int trunk = std::max(1, node_count / 4);
+            for (int i = 1; i <= trunk && i < node_count; i++)
+                parent[i] = i - 1;
+            for (int i = trunk + 1; i < node_count; i++)
+                parent[i] = (i - trunk - 1) % 3 == 0 ? trunk : i - 1;
+        }
+        return parent;
+    }
+
+    void build_graph(Graph &graph, const std::vector<int> &parent, const cv::Mat &source)
+    {
+        graph.env.graph = &graph;
+        graph.env.app = nullptr;
+        graph.Nodes.reserve(parent.size());
+        for (size_t i = 0; i < parent.size(); i++)
+        {
+            graph.Nodes.emplace_back(graph.get_next_id(), "节点");
+            auto &node = graph.Nodes.back();
+            node.Type = NodeType::Simple;
+            node.Outputs.emplace_back(graph.get_next_id(), "图像", PinType::Image);
+            if (parent[i] < 0)
+            {
+                node.OnExecute = [source](Graph *graph, Node *node)
+                {
+                    node->Outputs[0].SetValue(source);
+                    return ExecuteResult::Success();
+                };
+                continue;
+            }
+            node.Inputs.emplace_back(graph.get_next_id(), "图像", PinType::Image);
+            // 轮流使用几种内部并行的运算，输出和输入大小、类型相同
+            node.OnExecute = [op = i % 4](Graph *graph, Node *node)
+            {
+                cv::Mat image;
+                get_value(graph, node->Inputs[0], image);
+                cv::Mat result;
+                switch (op)
+                {
+                case 0:
+                    cv::GaussianBlur(image, result, cv::Size(9, 9), 0);
+                    break;
+                case 1:
+                    cv::erode(image, result, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(7, 7)));
+                    break;
+                case 2:
+                    cv::cvtColor(image, result, cv::COLOR_BGR2HSV);
+                    break;
+                default:
+                    cv::medianBlur(image, result, 5);
+                    break;
+                }
+                node->Outputs[0].SetValue(result);
+                return ExecuteResult::Success();
+            };
+        }
+        graph.build_nodes();
+        for (size_t i = 0; i < parent.size(); i++)
+            if (parent[i] >= 0)
+                graph.add_link(Link(graph.get_next_id(), graph.Nodes[parent[i]].Outputs[0].ID, graph.Nodes[i].Inputs[0].ID));
+    }
+
+    double measure_ms(const std::string &shape, int node_count, int repeat, size_t workers, const cv::Mat &source)
+    {
+        Graph graph;
+        build_graph(graph, generate(shape, node_count), source);
+        graph.env.incremental = false;
+        graph.env.profiling = false;
+        graph.env.set_worker_count(workers);
+        // 第一次执行包含编译执行计划、启动线程池和分配输出
+        graph.env.ExecuteNodes();
+        double total_ms = 0;
+        for (int i = 0; i < repeat; i++)
+        {
+            auto begin = std::chrono::steady_clock::now();
+            graph.env.ExecuteNodes();
+            total_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        }
+        graph.env.need_stop();
+        return total_ms / repeat;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    int node_count = argc > 1 ? std::max(2, std::atoi(argv[1])) : 32;
+    int repeat = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+    size_t workers = argc > 3 ? static_cast<size_t>(std::max(0, std::atoi(argv[3]))) : 0;
+    int width = argc > 4 ? std::max(16, std::atoi(argv[4])) : 1920;
+    int height = argc > 5 ? std::max(16, std::atoi(argv[5])) : 1080;
+
+    cv::Mat source(height, width, CV_8UC3);
+    cv::RNG(0x1234).fill(source, cv::RNG::UNIFORM, 0, 256);
+
+    const std::vector<std::string> shapes = {"chain", "wide", "mixed"};
+    const std::vector<opencv_parallel::policy> policies = {opencv_parallel::policy::opencv, opencv_parallel::policy::serial, opencv_parallel::policy::adaptive, opencv_parallel::policy::all};
+    auto &cv_parallel = opencv_parallel::instance();
+
+    printf("节点: %d 重复: %d 图像: %dx%d 工作线程: %zu OpenCV 线程: %d\n", node_count, repeat, width, height, workers ? workers : work_stealing_pool::default_worker_count(), cv::getNumThreads());
+    printf("%-8s", "形状");
+    for (auto policy : policies)
+        printf(" %12s", opencv_parallel::policy_names[static_cast<int>(policy)]);
+    printf("\n");
+
+    std::map<std::pair<std::string, opencv_parallel::policy>, double> results;
+    for (auto policy : policies)
+    {
+        cv_parallel.set_policy(policy);
+        for (auto &shape : shapes)
+            results[{shape, policy}] = measure_ms(shape, node_count, repeat, workers, source);
+    }
+    for (auto &shape : shapes)
+    {
+        printf("%-8s", shape.c_str());
+        for (auto policy : policies)
+            printf(" %9.2f ms", results[{shape, policy}]);
+        printf("\n");
+    }
+    printf("相对 opencv 的加速\n");
+    for (auto &shape : shapes)
+    {
+        printf("%-8s", shape.c_str());
+        for (auto policy : policies)
+            printf(" %11.2fx", results[{shape, opencv_parallel::policy::opencv}] / results[{shape, policy}]);
+        printf("\n");
+    }
+    auto stats = cv_parallel.get_stats();
+    printf("执行器线程池上的 cv::parallel_for_: 串行 %zu 次, 并行 %zu 次, 拆出 %zu 个任务\n", stats.inline_calls, stats.parallel_calls, stats.helper_tasks);
+    return 0;
+}
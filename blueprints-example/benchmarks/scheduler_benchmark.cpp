@@ -0,0 +1,289 @@
+// 调度器扩展性基准测试
+// 按参数生成合成图，通过 Graph 和 Link 建立节点和连线，测量 ExectureEnv::ExecuteNodes 执行全图的表现：
+//   完成时间：一次执行从开始到所有节点结束的时间
+//   每节点开销：完成时间超出理想时间的部分平摊到每个节点，理想时间取 总工作量/线程数 和 关键路径工作量 中较大的值
+//   利用率：节点实际执行的时间之和 / (完成时间 * 工作线程数)
+// 图的形状：
+//   chain    一条链，每个节点依赖前一个节点
+//   wide     一个源节点扇出到其余节点，再全部汇入一个汇点
+//   diamond  多个菱形串联，每个菱形从一个节点扇出 width 个节点再汇入一个节点
+//   random   随机有向无环图，每个节点随机依赖 1 到 3 个之前的节点，种子固定
+// 用法：scheduler-benchmark [选项]
+//   --shapes LIST            图的形状，逗号分隔，默认全部
+//   --sizes LIST             节点数量，逗号分隔，默认 10,100,1000,10000,50000
+//   --cost-us N              每个节点忙等 N 微秒，默认 0（空节点）
+//   --width N                diamond 每个菱形的宽度，默认 8
+//   -n, --repeat N           每个图执行 N 次取平均，默认 5 次
+//   -j, --workers N          工作线程数，默认使用硬件线程数
+//   --profile                执行时记录性能数据，用于测量性能记录本身的开销
+
+#include "base_nodes.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+
+namespace
+{
+    struct options
+    {
+        std::vector<std::string> shapes = {"chain", "wide", "diamond", "random"};
+        std::vector<int> sizes = {10, 100, 1000, 10000, 50000};
+        int cost_us = 0;
+        int width = 8;
+        int repeat = 5;
+        size_t workers = 0;
+        bool profile = false;
+    };
+
+    // 节点按下标的拓扑顺序给出，连线总是从小下标指向大下标
+    struct synthetic_graph
+    {
+        int node_count = 0;
+        std::vector<std::pair<int, int>> edges;
+    };
+
+    void print_usage()
+    {
+        printf("用法: scheduler-benchmark [--shapes chain,wide,diamond,random] [--sizes 10,100,...] [--cost-us 微秒] [--width 宽度] [-n 次数] [-j 线程数] [--profile]\n");
+    }
+
+    std::vector<std::string> split(const std::string &text)
+    {
+        std::vector<std::string> items;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+            if (!item.empty())
+                items.push_back(item);
+        return items;
+    }
+
+    std::optional<options> parse_options(int argc, char *argv[])
+    {
+        options opts;
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            bool has_value = i + 1 < argc;
+            if (arg == "--shapes" && has_value)
+            {
+                opts.shapes = split(argv[++i]);
+                for (auto &shape : opts.shapes)
+                    if (shape != "chain" && shape != "wide" && shape != "diamond" && shape != "random")
+                        return std::nullopt;
+            }
+            else if (arg == "--sizes" && has_value)
+            {
+                opts.sizes.clear();
+                for (auto &size : split(argv[++i]))
+                    opts.sizes.push_back(std::max(2, std::atoi(size.c_str())));
+            }
+            else if (arg == "--cost-us" && has_value)
+                opts.cost_us = std::max(0, std::atoi(argv[++i]));
+            else if (arg == "--width" && has_value)
+                opts.width = std::max(1, std::atoi(argv[++i]));
+            else if ((arg == "-n" || arg == "--repeat") && has_value)
+                opts.repeat = std::max(1, std::atoi(argv[++i]));
+            else if ((arg == "-j" || arg == "--workers") && has_value)
+                opts.workers = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+            else if (arg == "--profile")
+                opts.profile = true;
+            else
+                return std::nullopt;
+        }
+        if (opts.shapes.empty() || opts.sizes.empty())
+            return std::nullopt;
+        return opts;
+    }
+
+    synthetic_graph generate(const std::string &shape, int node_count, int width)
+    {
+        synthetic_graph g;
+        g.node_count = node_count;
+        if (shape == "chain")
+        {
+            for (int i = 1; i < node_count; i++)
+                g.edges.emplace_back(i - 1, i);
+        }
+        else if (shape == "wide")
+        {
+            const int sink = node_count - 1;
+            for (int i = 1; i < sink; i++)
+            {
+                g.edges.emplace_back(0, i);
+                g.edges.emplace_back(i, sink);
+            }
+            if (sink == 1)
+                g.edges.emplace_back(0, sink);
+        }
+        else if (shape == "diamond")
+        {
+            // 汇点同时是下一个菱形的源点，最后一个菱形可能不满 width
+            int source = 0;
+            int next = 1;
+            while (next < node_count)
+            {
+                const int branches = std::min(width, node_count - next - 1);
+                if (branches <= 0)
+                {
+                    g.edges.emplace_back(source, next);
+                    source = next++;
+                    continue;
+                }
+                const int sink = next + branches;
+                for (int i = next; i < sink; i++)
+                {
+                    g.edges.emplace_back(source, i);
+                    g.edges.emplace_back(i, sink);
+                }
+                source = sink;
+                next = sink + 1;
+            }
+        }
+        else
+        {
+            std::mt19937 rng(42);
+            for (int i = 1; i < node_count; i++)
+            {
+                std::uniform_int_distribution<int> pick(0, i - 1);
+                const int count = std::min(i, 1 + static_cast<int>(rng() % 3));
+                std::set<int> preds;
+                while (static_cast<int>(preds.size()) < count)
+                    preds.insert(pick(rng));
+                for (auto pred : preds)
+                    g.edges.emplace_back(pred, i);
+            }
+        }
+        return g;
+    }
+
+    // 最长路径上的节点数量
+    int longest_path(const synthetic_graph &g)
+    {
+        std::vector<int> depth(g.node_count, 1);
+        auto edges = g.edges;
+        std::sort(edges.begin(), edges.end(), [](const auto &a, const auto &b)
+                  { return a.second < b.second; });
+        for (auto &[from, to] : edges)
+            depth[to] = std::max(depth[to], depth[from] + 1);
+        return g.node_count > 0 ? *std::max_element(depth.begin(), depth.end()) : 0;
+    }
+
+    // 节点实际执行的时间之和（纳秒），由所有节点累加
+    std::atomic<int64_t> work_ns = 0;
+
+    // 每个节点的输入数量等于它的入度，输出为所有输入之和加一
+    void build_graph(Graph &graph, const synthetic_graph &g, int cost_us)
+    {
+        graph.env.graph = &graph;
+        graph.env.app = nullptr;
+        std::vector<int> indegree(g.node_count, 0);
+        for (auto &edge : g.edges)
+            indegree[edge.second]++;
+
+        graph.Nodes.reserve(g.node_count);
+        for (int i = 0; i < g.node_count; i++)
+        {
+            graph.Nodes.emplace_back(graph.get_next_id(), "节点");
+            auto &node = graph.Nodes.back();
+            node.Type = NodeType::Simple;
+            for (int k = 0; k < indegree[i]; k++)
+                node.Inputs.emplace_back(graph.get_next_id(), "输入", PinType::Int, 0);
+            node.Outputs.emplace_back(graph.get_next_id(), "输出", PinType::Int, 0);
+            node.OnExecute = [cost_us](Graph *graph, Node *node)
+            {
+                auto begin = std::chrono::steady_clock::now();
+                int sum = 1;
+                for (auto &input : node->Inputs)
+                {
+                    int value = 0;
+                    get_value(graph, input, value);
+                    sum = (sum + value) % 1000;
+                }
+                // 忙等模拟固定耗时的计算，不让出线程
+                if (cost_us > 0)
+                    while (std::chrono::steady_clock::now() - begin < std::chrono::microseconds(cost_us))
+                    {
+                    }
+                node->Outputs[0].SetValue(sum);
+                work_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+                return ExecuteResult::Success();
+            };
+        }
+        graph.build_nodes();
+
+        std::vector<int> next_input(g.node_count, 0);
+        graph.Links.reserve(g.edges.size());
+        for (auto &[from, to] : g.edges)
+            graph.add_link(Link(graph.get_next_id(), graph.Nodes[from].Outputs[0].ID, graph.Nodes[to].Inputs[next_input[to]++].ID));
+    }
+
+    struct measurement
+    {
+        double first_ms = 0;
+        double makespan_ms = 0;
+        double work_ms = 0;
+        double overhead_us = 0;
+        double utilization = 0;
+    };
+
+    measurement run(Graph &graph, const synthetic_graph &g, int repeat)
+    {
+        measurement m;
+        const double workers = static_cast<double>(graph.env.get_worker_count());
+
+        // 第一次执行包含编译执行计划和启动线程池
+        auto begin = std::chrono::steady_clock::now();
+        graph.env.ExecuteNodes();
+        m.first_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        work_ns = 0;
+        double total_ms = 0;
+        for (int i = 0; i < repeat; i++)
+        {
+            begin = std::chrono::steady_clock::now();
+            graph.env.ExecuteNodes();
+            total_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        }
+        m.makespan_ms = total_ms / repeat;
+        m.work_ms = work_ns / 1e6 / repeat;
+        // 每个节点的工作量近似相同，关键路径工作量按最长路径上的节点数量估计
+        const double critical_ms = m.work_ms / g.node_count * longest_path(g);
+        const double ideal_ms = std::max(m.work_ms / workers, critical_ms);
+        m.overhead_us = std::max(0.0, m.makespan_ms - ideal_ms) * 1000 / g.node_count;
+        m.utilization = m.makespan_ms > 0 ? m.work_ms / (m.makespan_ms * workers) : 0;
+        return m;
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    auto opts = parse_options(argc, argv);
+    if (!opts)
+    {
+        print_usage();
+        return 2;
+    }
+
+    printf("节点耗时: %d us 重复: %d\n", opts->cost_us, opts->repeat);
+    printf("%-8s %8s %8s %8s %12s %12s %12s %8s\n", "形状", "节点", "连线", "最长路径", "首次 ms", "完成 ms", "开销 us/节点", "利用率");
+    for (auto &shape : opts->shapes)
+    {
+        for (auto size : opts->sizes)
+        {
+            auto g = generate(shape, size, opts->width);
+            Graph graph;
+            build_graph(graph, g, opts->cost_us);
+            graph.env.incremental = false;
+            graph.env.profiling = opts->profile;
+            graph.env.set_worker_count(opts->workers);
+            auto m = run(graph, g, opts->repeat);
+            printf("%-8s %8d %8zu %8d %12.3f %12.3f %12.3f %7.1f%%\n", shape.c_str(), g.node_count, g.edges.size(), longest_path(g), m.first_ms, m.makespan_ms, m.overhead_us, m.utilization * 100);
+            graph.env.need_stop();
+        }
+    }
+    return 0;
+}
@@ -25,6 +25,7 @@
 #include "nodes/base_nodes.hpp"
 #include "nodes/node_ui_colors.hpp"
 #include "nodes/graph_ui.hpp"
+#include "nodes/profiler_ui.hpp"
 
 namespace ed = ax::NodeEditor;
 namespace util = ax::NodeEditor::Utilities;
@@ -251,18 +252,17 @@ struct Example : public Application
         ImGui::Spring(0.0f);
         if (ImGui::Button("清空"))
         {
-            m_Graph.Nodes.clear();
-            m_Graph.Links.clear();
+            m_Graph.clear();
             m_Graph.next_id = 0;
             ImGui::InsertNotification({ImGuiToastType::Info, 3000, "清空所有节点"});
         }
-        static bool loop_execute = false;
-        ImGui::Checkbox("循环执行", &loop_execute);
-        if (loop_execute)
+        bool loop_execute = m_Graph.env.is_looping();
+        if (ImGui::Checkbox("循环执行", &loop_execute))
         {
-            static int count = 0;
-            m_Graph.env.need_execute();
-            printf("循环执行次数: %d\n", count++);
+            if (loop_execute)
+                StartLoopExecute();
+            else
+                m_Graph.env.stop_loop();
         }
         if (ImGui::Button("自动排列"))
         {
@@ -312,13 +312,200 @@ struct Example : public Application
         ImGui::Spring();
         if (ImGui::Button("导出代码"))
         {
-            m_Graph.gen_ast_code();
+            // 过滤器为空时选择目录
+            ifd::FileDialog::Instance().Open("ExportCodeDialog", "导出代码到目录", "");
+        }
+        if (ifd::FileDialog::Instance().IsDone("ExportCodeDialog"))
+        {
+            if (ifd::FileDialog::Instance().HasResult())
+            {
+                std::string dir = ifd::FileDialog::Instance().GetResult().u8string();
+                auto result = m_Graph.gen_ast_code(dir);
+                if (result.has_error())
+                    Notifier::Add(Notif(Notif::Type::WARNING, "导出代码失败", result.Error->Message));
+                else
+                    Notifier::Add(Notif(Notif::Type::INFO, "导出代码", "已写入 " + dir + "/pipeline.cpp"));
+            }
+            ifd::FileDialog::Instance().Close();
         }
         ImGui::Spring();
         if (ImGui::Button("Edit Style"))
             showStyleEditor = true;
         ImGui::EndHorizontal();
         ImGui::Checkbox("Show Ordinals", &m_ShowOrdinals);
+        static int worker_count = static_cast<int>(m_Graph.env.get_worker_count());
+        ImGui::SetNextItemWidth(paneWidth * 0.5f);
+        ImGui::SliderInt("工作线程数", &worker_count, 1, static_cast<int>(work_stealing_pool::default_worker_count() * 2));
+        if (ImGui::IsItemDeactivatedAfterEdit())
+            m_Graph.env.set_worker_count(static_cast<size_t>(worker_count));
+        auto &cv_parallel = opencv_parallel::instance();
+        const char *cv_policy_labels[] = {"OpenCV 线程池", "节点内串行", "自适应", "全部线程"};
+        int cv_policy = static_cast<int>(cv_parallel.get_policy());
+        ImGui::SetNextItemWidth(paneWidth * 0.5f);
+        if (ImGui::BeginCombo("OpenCV 并行", cv_policy_labels[cv_policy]))
+        {
+            for (int i = 0; i < IM_ARRAYSIZE(cv_policy_labels); i++)
+            {
+                // 并行后端替换后不能恢复，不能再选择 OpenCV 线程池
+                auto policy = static_cast<opencv_parallel::policy>(i);
+                auto flags = policy == opencv_parallel::policy::opencv && cv_parallel.is_installed() ? ImGuiSelectableFlags_Disabled : ImGuiSelectableFlags_None;
+                if (ImGui::Selectable(cv_policy_labels[i], i == cv_policy, flags))
+                    cv_parallel.set_policy(policy);
+                if (i == cv_policy)
+                    ImGui::SetItemDefaultFocus();
+            }
+            ImGui::EndCombo();
+        }
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("节点里的 OpenCV 并行运算如何使用线程：自适应只拆给空闲的工作线程，就绪节点多时节点内部不再并行，避免线程数超过核心数\n换成执行器线程池后不能恢复为 OpenCV 线程池");
+        auto cv_stats = cv_parallel.get_stats();
+        ImGui::SameLine();
+        ImGui::Text("串行 %zu 并行 %zu 次", cv_stats.inline_calls, cv_stats.parallel_calls);
+        bool incremental = m_Graph.env.incremental;
+        if (ImGui::Checkbox("增量执行", &incremental))
+            m_Graph.env.incremental = incremental;
+        ImGui::SameLine();
+        bool critical_path_priority = m_Graph.env.critical_path_priority;
+        if (ImGui::Checkbox("关键路径优先", &critical_path_priority))
+            m_Graph.env.critical_path_priority = critical_path_priority;
+        ImGui::SameLine();
+        bool fingerprint_values = NodeWorldGlobal::fingerprint_values;
+        if (ImGui::Checkbox("内容指纹", &fingerprint_values))
+            NodeWorldGlobal::fingerprint_values = fingerprint_values;
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("图像和轮廓等大数组输出时计算内容哈希，和上次输出相同时不更新版本，下游节点不重新执行；关闭时只有截图、读文件等总是执行的节点比较，其余节点每次输出都视为变化");
+        ImGui::SameLine();
+        bool fuse_pointwise = m_Graph.env.fuse_pointwise;
+        if (ImGui::Checkbox("融合逐像素节点", &fuse_pointwise))
+            m_Graph.env.fuse_pointwise = fuse_pointwise;
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("连续的图像加减乘除、缩放取绝对值节点一次遍历完成，链中间节点的输出不再更新");
+        bool tiled_execution = m_Graph.env.tiled_execution;
+        if (ImGui::Checkbox("分块执行", &tiled_execution))
+            m_Graph.env.tiled_execution = tiled_execution;
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("连续的滤波、形态学、边缘和阈值节点在大图像上按块带邻域并行执行，结果和整幅图像执行相同，链中间节点的输出不再更新");
+        ImGui::SameLine();
+        static int tile_size = m_Graph.env.tile_size;
+        ImGui::SetNextItemWidth(paneWidth * 0.25f);
+        if (ImGui::InputInt("块大小", &tile_size, 64))
+            m_Graph.env.tile_size = tile_size = std::max(tile_size, 64);
+        bool low_memory = m_Graph.env.low_memory;
+        if (ImGui::Checkbox("低内存执行", &low_memory))
+            m_Graph.env.low_memory = low_memory;
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("图像输出的所有下游节点执行完后立即释放，固定的节点和图像查看器读取的输出除外，被释放的节点下次执行时重新计算");
+        ImGui::SameLine();
+        ImGui::Text("图像内存峰值: %.1f MB 释放: %.1f MB", m_Graph.env.peak_resident_bytes / (1024.0 * 1024.0), m_Graph.env.released_bytes / (1024.0 * 1024.0));
+        ImGui::SameLine();
+        ImGui::Text("图像分配: %zu 次", m_Graph.env.last_run_allocations.load());
+        bool trace_enabled = m_Graph.env.trace_enabled;
+        if (ImGui::Checkbox("记录执行轨迹", &trace_enabled))
+            m_Graph.env.trace_enabled = trace_enabled;
+        if (ImGui::IsItemHovered())
+            ImGui::SetTooltip("记录每个节点在哪个线程上执行、排队等待和执行的时间、输出大小，导出为 Chrome trace 格式，可以在 Perfetto 中打开");
+        ImGui::SameLine();
+        if (ImGui::Button("导出轨迹"))
+            ifd::FileDialog::Instance().Save("ExportTraceDialog", "导出执行轨迹", "Trace (*.json){.json},.*");
+        if (ifd::FileDialog::Instance().IsDone("ExportTraceDialog"))
+        {
+            if (ifd::FileDialog::Instance().HasResult())
+            {
+                std::string path = ifd::FileDialog::Instance().GetResult().u8string();
+                if (m_Graph.env.trace.write(path))
+                    Notifier::Add(Notif(Notif::Type::INFO, "导出轨迹", "已写入 " + path));
+                else
+                    Notifier::Add(Notif(Notif::Type::WARNING, "导出轨迹失败", "无法写入 " + path));
+            }
+            ifd::FileDialog::Instance().Close();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("清空轨迹"))
+            m_Graph.env.trace.clear();
+        ImGui::SameLine();
+        ImGui::Text("事件: %zu", m_Graph.env.trace.size());
+        ImGui::SameLine();
+        ImGui::Checkbox("性能面板", &m_ShowProfiler);
+        for (auto &resource : m_Graph.env.resources.get_stats())
+            ImGui::Text("资源 %s: 上限 %d 执行中 %d 排队 %zu, 已排队 %zu/%zu 次 平均等待 %.2f ms 最长 %.2f ms", resource.name.c_str(), resource.limit, resource.running, resource.waiting, resource.waits, resource.acquired,
+                        resource.waits ? resource.total_wait_ms / resource.waits : 0.0, resource.max_wait_ms);
+        ImGui::Text("完成时间 预测: %.2f ms 实际: %.2f ms 关键路径: %.2f ms", m_Graph.env.predicted_makespan_ms.load(), m_Graph.env.actual_makespan_ms.load(), m_Graph.env.critical_path_ms.load());
+        bool use_result_cache = m_Graph.env.use_result_cache;
+        if (ImGui::Checkbox("结果缓存", &use_result_cache))
+            m_Graph.env.use_result_cache = use_result_cache;
+        if (use_result_cache)
+        {
+            auto &cache = m_Graph.env.result_cache;
+            static int cache_budget_mb = static_cast<int>(cache.get_budget() / (1024 * 1024));
+            ImGui::SetNextItemWidth(paneWidth * 0.5f);
+            ImGui::SliderInt("缓存上限(MB)", &cache_budget_mb, 16, 4096);
+            if (ImGui::IsItemDeactivatedAfterEdit())
+                cache.set_budget(static_cast<size_t>(cache_budget_mb) * 1024 * 1024);
+            ImGui::Text("缓存: %zu 项 %.1f MB", cache.get_count(), cache.get_used() / (1024.0 * 1024.0));
+            ImGui::SameLine();
+            if (ImGui::Button("清空缓存"))
+                cache.clear();
+        }
+        static int stream_frame_count = 100;
+        static int stream_max_in_flight = 4;
+        if (ImGui::Button("流式执行"))
+            m_Graph.env.async_execute_stream(static_cast<size_t>(stream_frame_count), static_cast<size_t>(stream_max_in_flight));
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(paneWidth * 0.25f);
+        if (ImGui::InputInt("帧数", &stream_frame_count))
+            stream_frame_count = std::max(stream_frame_count, 1);
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(paneWidth * 0.25f);
+        if (ImGui::InputInt("并行帧数", &stream_max_in_flight))
+            stream_max_in_flight = std::max(stream_max_in_flight, 1);
+        if (m_Graph.env.stream_frame_count > 0)
+            ImGui::Text("流式执行: %zu/%zu 帧 %.1f 帧/秒", m_Graph.env.stream_finished_frames.load(), m_Graph.env.stream_frame_count.load(), m_Graph.env.stream_fps.load());
+        ImGui::SetNextItemWidth(paneWidth * 0.25f);
+        ImGui::InputFloat("循环频率(Hz)", &m_LoopRateHz, 1.0f, 10.0f, "%.1f");
+        bool loop_changed = ImGui::IsItemDeactivatedAfterEdit();
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(paneWidth * 0.25f);
+        const char *loop_policies[] = {"忙时跳过", "丢弃旧的", "排队"};
+        loop_changed |= ImGui::Combo("忙时策略", &m_LoopPolicy, loop_policies, IM_ARRAYSIZE(loop_policies));
+        if (m_LoopPolicy == static_cast<int>(loop_scheduler::policy::queue))
+        {
+            ImGui::SetNextItemWidth(paneWidth * 0.25f);
+            ImGui::InputInt("队列长度", &m_LoopQueueLimit);
+            loop_changed |= ImGui::IsItemDeactivatedAfterEdit();
+            m_LoopQueueLimit = std::max(m_LoopQueueLimit, 1);
+        }
+        m_LoopRateHz = std::max(m_LoopRateHz, 0.1f);
+        // 修改参数后重新开始循环
+        if (loop_changed && m_Graph.env.is_looping())
+            StartLoopExecute();
+        if (m_Graph.env.is_looping())
+        {
+            auto stats = m_Graph.env.get_loop_stats();
+            ImGui::Text("循环: %.1f Hz 执行 %zu 跳过 %zu 取消 %zu 超时 %zu 失败 %zu", stats.rate_hz, stats.runs, stats.skipped, stats.cancelled, stats.missed_deadlines, stats.failed_runs);
+            ImGui::Text("节拍抖动 平均 %.2f ms 最大 %.2f ms 延迟 %.1f ms", stats.jitter_mean_ms, stats.jitter_max_ms, stats.last_latency_ms);
+        }
+        bool cancel_stale_run = m_Graph.env.cancel_stale_run;
+        if (ImGui::Checkbox("最新请求优先", &cancel_stale_run))
+            m_Graph.env.cancel_stale_run = cancel_stale_run;
+        ImGui::SameLine();
+        if (ImGui::Button("取消执行"))
+            m_Graph.env.cancel_run();
+        float deadline_ms = static_cast<float>(m_Graph.env.deadline_ms.load());
+        ImGui::SetNextItemWidth(paneWidth * 0.5f);
+        if (ImGui::InputFloat("执行期限(ms)", &deadline_ms, 10.0f, 100.0f, "%.0f"))
+            m_Graph.env.deadline_ms = std::max(deadline_ms, 0.0f);
+        auto cancel_report = m_Graph.env.get_cancel_report();
+        if (!cancel_report.nodes.empty())
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "上次执行%s，跳过 %zu 个节点", cancel_report.reason.c_str(), cancel_report.nodes.size());
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::BeginTooltip();
+                for (auto &name : cancel_report.nodes)
+                    ImGui::TextUnformatted(name.c_str());
+                ImGui::EndTooltip();
+            }
+        }
 
         if (showStyleEditor)
             ShowStyleEditor(&showStyleEditor);
@@ -509,9 +696,14 @@ struct Example : public Application
     {
         UpdateTouch();
 
+        // 开始执行期间到达的请求
+        m_Graph.env.async_execute();
+
         auto &io = ImGui::GetIO();
 
         ImGui::Text("帧率测试: %.2f (%.2gms) 上次执行全体耗时: %.2f ms", io.Framerate, io.Framerate ? 1000.0f / io.Framerate : 0.0f, m_Graph.env.all_execute_time / 1000000.0);
+        ImGui::Text("上次执行节点: %zu 沿用输出节点: %zu", m_Graph.env.executed_count.load(), m_Graph.env.reused_count.load());
+        ImGui::Text("执行计划编译次数: %zu", m_Graph.env.plan_compile_count.load());
 
         ed::SetCurrentEditor(m_Editor);
 
@@ -623,20 +815,22 @@ struct Example : public Application
                                 {
                                     if (has_convertor)
                                     {
+                                        // 创建节点可能导致节点数组重新分配，startPin 和 endPin 会失效，先取出需要的值
+                                        auto input_pin_type = startPin->Type;
+                                        auto output_pin_type = endPin->Type;
                                         auto convert_factory = convert_factory_it->second;
                                         auto convert_node = convert_factory([&]()
                                                                             { return m_Graph.get_next_id(); },
                                                                             [&](Node *node)
                                                                             { m_Graph.build_node(node); },
                                                                             m_Graph.Nodes, this);
+                                        m_Graph.build_nodes();
 
                                         createNewNode = false;
                                         // 设置新建节点位置为目标节点左侧
                                         auto convert_node_size = ed::GetNodeSize(convert_node->ID);
                                         ed::SetNodePosition(convert_node->ID, end_node_pos - ImVec2(convert_node_size.x + 200, 0));
 
-                                        auto input_pin_type = startPin->Type;
-                                        auto output_pin_type = endPin->Type;
                                         int input_type_index_for_convert_node = 0;
                                         int output_type_index_for_convert_node = 0;
                                         for (int i = 0; i < convert_node->Inputs.size(); i++)
@@ -655,17 +849,13 @@ struct Example : public Application
                                                 break;
                                             }
                                         }
-                                        // TODO: 存在问题，会导致崩溃
-                                        m_Graph.Links.emplace_back(Link(m_Graph.get_next_id(), startPinId, convert_node->Inputs[input_type_index_for_convert_node].ID));
-                                        m_Graph.Links.emplace_back(Link(m_Graph.get_next_id(), convert_node->Outputs[output_type_index_for_convert_node].ID, endPinId));
-                                        m_Graph.Links.back().Color = ui::GetIconColor(startPin->Type);
-                                        m_Graph.Links.back().Color = ui::GetIconColor(endPin->Type);
+                                        m_Graph.add_link(Link(m_Graph.get_next_id(), startPinId, convert_node->Inputs[input_type_index_for_convert_node].ID))->Color = ui::GetIconColor(input_pin_type);
+                                        m_Graph.add_link(Link(m_Graph.get_next_id(), convert_node->Outputs[output_type_index_for_convert_node].ID, endPinId))->Color = ui::GetIconColor(output_pin_type);
                                     }
                                     else
                                     {
                                         // 创建新的连接
-                                        m_Graph.Links.emplace_back(Link(m_Graph.get_next_id(), startPin->ID, endPin->ID));
-                                        m_Graph.Links.back().Color = ui::GetIconColor(startPin->Type);
+                                        m_Graph.add_link(Link(m_Graph.get_next_id(), startPin->ID, endPin->ID))->Color = ui::GetIconColor(startPin->Type);
                                     }
                                 }
                             }
@@ -702,24 +892,14 @@ struct Example : public Application
                     while (ed::QueryDeletedNode(&nodeId))
                     {
                         if (ed::AcceptDeletedItem())
-                        {
-                            auto id = std::find_if(m_Graph.Nodes.begin(), m_Graph.Nodes.end(), [nodeId](auto &node)
-                                                   { return node.ID == nodeId; });
-                            if (id != m_Graph.Nodes.end())
-                                m_Graph.Nodes.erase(id);
-                        }
+                            m_Graph.remove_node(nodeId);
                     }
 
                     ed::LinkId linkId = 0;
                     while (ed::QueryDeletedLink(&linkId))
                     {
                         if (ed::AcceptDeletedItem())
-                        {
-                            auto id = std::find_if(m_Graph.Links.begin(), m_Graph.Links.end(), [linkId](auto &link)
-                                                   { return link.ID == linkId; });
-                            if (id != m_Graph.Links.end())
-                                m_Graph.Links.erase(id);
-                        }
+                            m_Graph.remove_link(linkId);
                     }
                 }
                 ed::EndDelete();
@@ -764,6 +944,12 @@ struct Example : public Application
                 {
                     async_execute_node(node);
                 }
+                if (ImGui::MenuItem("固定输出", nullptr, node->Pinned))
+                {
+                    // 固定状态记录在执行计划里
+                    node->Pinned = !node->Pinned;
+                    m_Graph.invalidate_index();
+                }
                 ImGui::Separator();
                 if (ImGui::MenuItem("折叠"))
                 {
@@ -880,8 +1066,7 @@ struct Example : public Application
                             if (startPin->Kind == PinKind::Input)
                                 std::swap(startPin, endPin);
                             // 创建新的连接
-                            m_Graph.Links.emplace_back(Link(m_Graph.get_next_id(), startPin->ID, endPin->ID));
-                            m_Graph.Links.back().Color = ui::GetIconColor(startPin->Type);
+                            m_Graph.add_link(Link(m_Graph.get_next_id(), startPin->ID, endPin->ID))->Color = ui::GetIconColor(startPin->Type);
                             break;
                         }
                     }
@@ -912,7 +1097,7 @@ struct Example : public Application
                     if (input->HasImage())
                     {
                         auto size = ImGui::GetContentRegionAvail();
-                        auto image_size = std::get<cv::Mat>(input->Value).size();
+                        auto image_size = std::get<cv::Mat>(*input->Value).size();
                         auto texture_size = ImVec2(static_cast<float>(image_size.width), static_cast<float>(image_size.height));
                         ImGuiTexInspect::BeginInspectorPanel("Inspector", input->ImageTexture, texture_size, ImGuiTexInspect::InspectorFlags_NoGrid, ImGuiTexInspect::SizeExcludingBorder(ImVec2(size.x - 2, size.y - 2)));
                         ImGuiTexInspect::DrawAnnotations(ImGuiTexInspect::ValueText(ImGuiTexInspect::ValueText::BytesDec));
@@ -960,14 +1145,8 @@ struct Example : public Application
             drawList->PopClipRect();
         }
 
-        static bool show_profiler_window = true;
-        // if (show_profiler_window)
-        //{
-        //     ImGui::Begin("Profiler Window", &show_profiler_window);
-        //     auto &entry = profiler._entries[profiler.GetCurrentEntryIndex()];
-        //     ImGuiWidgetFlameGraph::PlotFlame("CPU", &ProfilerValueGetter, &entry, Profiler::_StageCount, 0, "Main Thread", FLT_MAX, FLT_MAX, ImVec2(400, 0));
-        //     ImGui::End();
-        // }
+        if (m_ShowProfiler)
+            draw_profiler_window(m_Graph, &m_ShowProfiler);
 
         // ImGui::PushFont(io.Fonts->Fonts[1]);
         // ImGui::PopFont();
@@ -998,10 +1177,14 @@ struct Example : public Application
 
     std::list<std::future<void>> node_execute_futures;
 
+    void StartLoopExecute()
+    {
+        m_Graph.env.start_loop(m_LoopRateHz, static_cast<loop_scheduler::policy>(m_LoopPolicy), static_cast<size_t>(m_LoopQueueLimit));
+    }
+
     void async_execute_node(Node *node)
     {
-        node_execute_futures.emplace_back(std::async(std::launch::async, [node, this]()
-                                                     { node->execute(&m_Graph); }));
+        node_execute_futures.emplace_back(m_Graph.env.async_execute_node(node));
     }
 
     void try_clear_futures()
@@ -1029,6 +1212,11 @@ struct Example : public Application
     const float m_TouchTime = 1.0f;
     std::map<ed::NodeId, float, NodeIdLess> m_NodeTouchTime;
     bool m_ShowOrdinals = false;
+    bool m_ShowProfiler = false;
+    // 循环执行的频率、忙时策略和排队长度
+    float m_LoopRateHz = 30.0f;
+    int m_LoopPolicy = static_cast<int>(loop_scheduler::policy::skip_if_busy);
+    int m_LoopQueueLimit = 2;
 };
 
 int main(int argc, char **argv)
@@ -8,21 +8,28 @@
 #include "child_nodes/child_nodes.hpp"
 #include "node_ui_colors.hpp"
 #include "graph_ui.hpp"
+#include "node_codegen.hpp"
 
 void Pin::event_value_changed()
 {
+    // 命令行工具没有界面，不创建纹理，也不链接界面程序库
+#ifndef IMAGE_NODE_HEADLESS
     if (std::this_thread::get_id() != NodeWorldGlobal::main_thread_id)
         return;
     if (Type == PinType::Image && app)
     {
-        cv::Mat image = std::get<cv::Mat>(Value);
-        if (image.empty())
+        const cv::Mat &value = std::get<cv::Mat>(*Value);
+        if (value.empty())
             return;
         try
         {
-            if ((image.depth() != CV_8U) || (image.depth() != CV_8S))
+            // 端口的值是共享的，转换结果写入新的图像，不能原地修改
+            cv::Mat image;
+            if ((value.depth() != CV_8U) || (value.depth() != CV_8S))
                 // 根据单通道图像的深度(16,32,64)，将其转换为8位图像，除以255.0
-                cv::normalize(image, image, 0, 255, cv::NORM_MINMAX, CV_8U);
+                cv::normalize(value, image, 0, 255, cv::NORM_MINMAX, CV_8U);
+            else
+                image = value;
             if (image.channels() == 1)
                 cv::cvtColor(image, image, cv::COLOR_GRAY2RGBA);
             else if (image.channels() == 3)
@@ -43,6 +50,7 @@ void Pin::event_value_changed()
             return;
         }
     }
+#endif
 }
 
 Pin &node_ui::get_virtual_input()
@@ -370,30 +378,12 @@ void Graph::auto_arrange()
     }
 }
 
-void Graph::gen_ast_code()
+ExecuteResult Graph::gen_ast_code(const std::string &output_dir)
 {
-    std::map<std::string, std::string> global_codes;
-    for (auto &node : Nodes)
-    {
-        if (global_codes.find(node.Name) != global_codes.end())
-            continue;
-        if (node.ast.global_define.empty())
-            continue;
-        global_codes.insert({node.Name, node.ast.global_define});
-    }
-    std::string global_defines;
-    for (auto &[_, code] : global_codes)
-        global_defines += code + "\n";
-    std::cout << global_defines << "\n";
-
-    std::string ast_code;
-    for (auto &[_, node] : env.sorted_nodes)
-    {
-        if (node == nullptr)
-            continue;
-        ast_code += node->ast.code + "\n";
-    }
-    std::cout << ast_code << "\n";
+    node_code_generator generator;
+    if (auto result = generator.generate(this); result.has_error())
+        return result;
+    return generator.write(output_dir);
 }
 
 void node_ui::draw_input_pin(Pin &input)
@@ -889,6 +879,9 @@ void node_ui::draw_image_node(Node *node)
         // builder->Footer();
         ImGui::Spring(1);
         std::string footer = "耗时：" + node->get_last_execute_time();
+        auto cache_stats = node->graph->env.result_cache.get_stats(node->ID.Get());
+        if (cache_stats.hits + cache_stats.misses > 0)
+            footer += " 缓存命中：" + std::to_string(cache_stats.hits) + "/" + std::to_string(cache_stats.hits + cache_stats.misses);
         ImGui::TextUnformatted(footer.c_str());
         if (node->is_running())
         {
@@ -1057,6 +1050,9 @@ void node_ui::draw_flow_node(Node *node)
         // builder->Footer();
         ImGui::Spring(1);
         std::string footer = "耗时：" + node->get_last_execute_time();
+        auto cache_stats = node->graph->env.result_cache.get_stats(node->ID.Get());
+        if (cache_stats.hits + cache_stats.misses > 0)
+            footer += " 缓存命中：" + std::to_string(cache_stats.hits) + "/" + std::to_string(cache_stats.hits + cache_stats.misses);
         ImGui::TextUnformatted(footer.c_str());
         if (node->is_running())
         {
@@ -1102,8 +1098,10 @@ void factory_group_init()
     node_factorys::get_instance().register_group_from_factorys(groups, BlueprintNodesFactorys);
     node_factorys::get_instance().register_group_from_factorys(groups, FlowSourceNodesFactorys);
     node_factorys::get_instance().register_group_from_factorys(groups, MaaTaskFlowNodesFactorys);
+#ifndef IMAGE_NODE_HEADLESS
     node_factorys::get_instance().register_group_from_factorys(groups, Win32WindowNodesFactorys);
     node_factorys::get_instance().register_group_from_factorys(groups, Win32SoftInputNodesFactorys);
+#endif
     node_factorys::get_instance().register_group_from_factorys(groups, BaseTypeNodesFactorys);
     node_factorys::get_instance().register_group_from_factorys(groups, BaseStringNodesFactorys);
     node_factorys::get_instance().register_group_from_factorys(groups, BaseConvertNodesFactorys);
@@ -1129,8 +1127,10 @@ std::map<NodeType, NodeWorldGlobal::FactoryGroupFunc_t> NodeWorldGlobal::nodeFac
         {NodeType::Blueprint, BlueprintNodes},
         {NodeType::FlowSource, FlowSourceNodes},
         {NodeType::MaaTaskFlow, MaaTaskFlowNodes},
+#ifndef IMAGE_NODE_HEADLESS
         {NodeType::Win32, Win32WindowNodes},
         {NodeType::Win32Input, Win32SoftInputNodes},
+#endif
         {NodeType::BaseType, BaseTypeNodes},
         {NodeType::BaseString, BaseStringNodes},
 
@@ -10,18 +10,34 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
+#include <queue>
+#include <algorithm>
+#include <limits>
+#include <unordered_map>
 #include <functional>
 #include <variant>
 #include <optional>
 #include <atomic>
 #include <future>
+#include <shared_mutex>
 
 #include <opencv2/opencv.hpp>
 
 #include "../utilities/builders.h"
 #include "../utilities/widgets.h"
+#include "../utilities/work_stealing_pool.hpp"
 
 #include "node_port_types.hpp"
+#include "node_result_cache.hpp"
+#include "loop_scheduler.hpp"
+#include "pointwise_fusion.hpp"
+#include "tiled_execution.hpp"
+#include "mat_allocation_counter.hpp"
+#include "execution_trace.hpp"
+#include "execution_profile.hpp"
+#include "resource_limiter.hpp"
+#include "opencv_parallel.hpp"
 
 static inline ImRect ImGui_GetItemRect()
 {
@@ -128,37 +144,55 @@ struct NodeWorldGlobal
     static std::map<NodeType, FactoryGroupFunc_t> nodeFactories;
     static std::map<std::pair<PinType, PinType>, NodeFactory_t> registerLinkAutoConvertNodeFactories;
     inline static std::thread::id main_thread_id = std::this_thread::get_id();
+    // 端口值版本号，全局递增，保证不同端口的版本号也不会重复
+    inline static std::atomic<uint64_t> pin_version_counter = 0;
+    static uint64_t next_pin_version() { return ++pin_version_counter; }
+    // 写入图像和大数组时是否比较内容指纹，关闭时只有总是执行的节点比较，其余节点每次写入都视为变化
+    inline static std::atomic<bool> fingerprint_values = false;
 };
 
+// 执行上下文，节点在上下文中执行时端口的值读写上下文而不是图中的端口
+struct execution_context;
+// 当前线程正在执行的节点所属的上下文，直接在图上执行时为空
+inline thread_local execution_context *current_context = nullptr;
+struct Pin;
+inline void set_context_value(execution_context *context, Pin *pin, const shared_port_value &value);
+inline void set_context_execute_time(execution_context *context, ed::NodeId id, std::chrono::steady_clock::duration time);
+
 struct Pin
 {
     ed::PinId ID;
     ::Node *Node;
     std::string Name;
     PinType Type;
-    port_value_t Value;
+    // 共享的值，复制端口或读取值时不复制数组
+    shared_port_value Value;
     PinKind Kind;
     bool NeedInputSource = false;
     bool IsConnected;
     bool HoldImageTexture;
     void *ImageTexture = nullptr;
     bool needUpdateTexture = false;
+    // 值的版本号，每次值发生变化时更新
+    uint64_t Version = 0;
+    // 上一次写入的图像或大数组的内容指纹，只在比较内容指纹时计算
+    std::optional<uint64_t> Fingerprint;
     Application *app;
     void event_value_changed();
 
     bool can_execute()
     {
-        if (Kind == PinKind::Input && Value.valueless_by_exception())
+        if (Kind == PinKind::Input && Value->valueless_by_exception())
         {
             return false;
         }
         return true;
     }
 
-    Pin(int id, const char *name, PinType type, port_value_t value = port_value_t()) : ID(id), Node(nullptr), Name(name), Type(type), Value(value), Kind(PinKind::Input)
+    Pin(int id, const char *name, PinType type, port_value_t value = port_value_t()) : ID(id), Node(nullptr), Name(name), Type(type), Value(std::move(value)), Kind(PinKind::Input)
     {
     }
-    Pin(int id, PinType type, std::string name = "", port_value_t value = port_value_t()) : ID(id), Node(nullptr), Name(name), Type(type), Value(value), Kind(PinKind::Input)
+    Pin(int id, PinType type, std::string name = "", port_value_t value = port_value_t()) : ID(id), Node(nullptr), Name(name), Type(type), Value(std::move(value)), Kind(PinKind::Input)
     {
         if (name.empty())
             Name = typeLabelNames.at(type);
@@ -167,10 +201,10 @@ struct Pin
     template <typename T>
     bool GetValue(T &value)
     {
-        if (typeMap.at(typeid(T).hash_code()) == Type && std::holds_alternative<T>(Value))
+        if (pin_type_of<T>() == Type && std::holds_alternative<T>(*Value))
         {
-            value = std::get<T>(Value);
-            if (std::holds_alternative<cv::Mat>(Value))
+            value = std::get<T>(*Value);
+            if (std::holds_alternative<cv::Mat>(*Value))
             {
                 if (needUpdateTexture)
                 {
@@ -183,25 +217,26 @@ struct Pin
         return false;
     }
 
+    // 共享端口的值，不复制
+    template <typename T>
+    bool GetValue(shared_value<T> &value)
+    {
+        if (pin_type_of<T>() != Type)
+            return false;
+        return value.assign(Value);
+    }
+
     template <typename T>
     bool SetValue(T value)
     {
-        if (typeMap.at(typeid(T).hash_code()) == Type)
+        if (pin_type_of<T>() == Type)
         {
-            if (std::holds_alternative<T>(Value) == false)
+            if (current_context)
             {
-                Value = value;
-                needUpdateTexture = true;
-                event_value_changed();
+                set_context_value(current_context, this, std::move(value));
                 return true;
             }
-            bool isChanged = !is_equal(std::get<T>(Value), value);
-            Value = value;
-            if (isChanged)
-            {
-                needUpdateTexture = true;
-                event_value_changed();
-            }
+            update_value(std::move(value));
             return true;
         }
         return false;
@@ -210,42 +245,115 @@ struct Pin
     template <typename T, class Pred>
     bool SetValue(T value, Pred pred)
     {
-        if (typeMap.at(typeid(T).hash_code()) == Type)
+        if (pin_type_of<T>() == Type)
         {
-            if (std::holds_alternative<T>(Value) == false)
+            if (current_context)
             {
-                Value = value;
-                needUpdateTexture = true;
-                event_value_changed();
+                set_context_value(current_context, this, std::move(value));
                 return true;
             }
-            bool isChanged = !is_equal(std::get<T>(Value), value);
-            Value = value;
-            if (isChanged)
-            {
-                needUpdateTexture = true;
-                event_value_changed();
+            if (update_value(std::move(value)))
                 pred();
-            }
             return true;
         }
         return false;
     }
 
+    // 设置任意类型的值，用于发布缓存的输出，共享 value 持有的值
+    void SetPortValue(const shared_port_value &value)
+    {
+        if (current_context)
+        {
+            set_context_value(current_context, this, value);
+            return;
+        }
+        if (Value.same(value))
+            return;
+        if (is_large_port_value(*value))
+        {
+            replace_large_value(value);
+            return;
+        }
+        if (Value->index() == value->index() && is_equal(*Value, *value))
+            return;
+        Value = value;
+        mark_changed();
+    }
+
+    // 取出上一次输出的图像，作为本次输出的目标缓冲区，大小和类型相同时 OpenCV 直接写入不再分配
+    // 只有端口是这块内存的唯一持有者时才复用：下游端口、结果缓存或界面还引用旧图像时返回空图像
+    // 取出后端口为空
+    cv::Mat take_image_buffer()
+    {
+        if (current_context || Type != PinType::Image || !Value.unique() || !std::holds_alternative<cv::Mat>(*Value))
+            return cv::Mat();
+        cv::Mat buffer = std::get<cv::Mat>(*Value);
+        // 除了端口的共享值，buffer 是唯一的引用
+        if (buffer.empty() || !buffer.u || buffer.u->refcount != 2 || buffer.isSubmatrix())
+            return cv::Mat();
+        Value = cv::Mat();
+        return buffer;
+    }
+
     bool HasImage()
     {
         if (Type != PinType::Image)
             return false;
-        if (std::holds_alternative<cv::Mat>(Value) == false)
-            return false;
-        if (std::get<cv::Mat>(Value).empty())
+        if (std::holds_alternative<cv::Mat>(*Value) == false)
             return false;
+        // 值被释放后也要更新一次，销毁旧的纹理
         if (needUpdateTexture)
         {
             event_value_changed();
             needUpdateTexture = false;
         }
-        return true;
+        return !std::get<cv::Mat>(*Value).empty();
+    }
+
+private:
+    // 总是执行的节点（截图、读文件等）每次执行都会写入输出，内容不变时也应该让下游跳过，所以始终比较指纹
+    bool use_fingerprint() const;
+
+    void mark_changed()
+    {
+        Version = NodeWorldGlobal::next_pin_version();
+        needUpdateTexture = true;
+        event_value_changed();
+    }
+
+    // 写入新值，返回值是否变化
+    // 小的值直接比较，相同时保留原来的共享值
+    template <typename T>
+    bool update_value(T value)
+    {
+        if constexpr (is_large_value_v<T>)
+            return replace_large_value(std::move(value));
+        else
+        {
+            if (std::holds_alternative<T>(*Value) && is_equal(std::get<T>(*Value), value))
+                return false;
+            Value = std::move(value);
+            mark_changed();
+            return true;
+        }
+    }
+
+    // 图像和大数组不逐个元素比较，默认每次写入都视为变化，版本号的比较是 O(1) 的
+    // 比较内容指纹时只对新值计算一次哈希，和上一次写入时保存的指纹比较，内容相同时不更新版本号，下游节点不必重新执行
+    bool replace_large_value(shared_port_value value)
+    {
+        bool changed = true;
+        std::optional<uint64_t> fingerprint;
+        if (use_fingerprint())
+        {
+            fingerprint = hash_value(*value);
+            changed = !fingerprint || !Fingerprint || *fingerprint != *Fingerprint;
+        }
+        Value = std::move(value);
+        Fingerprint = fingerprint;
+        if (changed)
+            mark_changed();
+        return changed;
     }
 };
 
@@ -322,6 +430,7 @@ struct node_state_value
 {
 };
 
+// 节点的代码模板，导出代码时使用，$n 的约定见 node_codegen.hpp
 struct node_ast
 {
     std::string name;
@@ -347,6 +456,8 @@ struct Node
 {
     ed::NodeId ID;
     std::string Name;
+    // 类型名称：创建节点的工厂名称，不随显示名称变化，结果缓存按它区分不同类型的节点
+    std::string TypeName;
     std::vector<Pin> Inputs;
     std::vector<Pin> Outputs;
     ImColor Color;
@@ -364,15 +475,21 @@ struct Node
         return ExecuteResult::ErrorNode(node->ID, "Null Impl: " + node->Name);
     };
 
+    // 逐像素运算节点返回对输入图像 Inputs[0] 做的运算，结果写入 Outputs[0]，参数不支持时返回空
+    // 执行计划把只有一个下游的连续逐像素节点融合为一次遍历
+    std::function<std::optional<pointwise_op>(Graph *, Node *)> OnPointwise;
+    // 局部运算节点（滤波、形态学等）返回邻域半径和在填充好邻域的图像上执行的运算，参数或输入类型不支持时返回空
+    // 最后一个参数是进入这个节点的图像类型，执行计划把连续的局部运算节点融合，大图像按块带邻域执行
+    std::function<std::optional<local_op>(Graph *, Node *, int)> OnLocal;
+
     std::function<ExecuteResult(Graph *, Node *)> OnExecuteEx = [](Graph *graph, Node *node)
     {
         node->RunningThreadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
-        node->BeginExecuteTime = std::chrono::steady_clock::now();
+        auto begin = std::chrono::steady_clock::now();
         node->IsRunning = true;
         auto result = node->OnExecute(graph, node);
         node->IsRunning = false;
-        node->EndExecuteTime = std::chrono::steady_clock::now();
-        node->ExecuteTime = std::chrono::duration_cast<std::chrono::steady_clock::duration>(*node->EndExecuteTime - *node->BeginExecuteTime);
+        node->record_execute_time(begin, std::chrono::steady_clock::now());
         return result;
     };
 
@@ -383,11 +500,25 @@ struct Node
     std::atomic<bool> IsRunning = false;
     std::atomic<size_t> RunningThreadId = 0;
 
+    // 总是执行：依赖外部状态或有副作用的节点（截图、读文件、窗口操作等），增量执行时不会被跳过
+    bool AlwaysExecute = false;
+    // 需要重新执行，新建和反序列化的节点需要执行一次
+    std::atomic<bool> Dirty = true;
+    // 固定：低内存执行时不释放这个节点的输出，也不释放它读取的上游输出
+    bool Pinned = false;
+    // 资源类别："名称:上限"，同一类别同时执行的节点数量不超过上限，为空时不限制
+    // 用于不能并发的节点（OCR）和同时执行太多会互相拖慢的节点（占满内存带宽的滤波、特征提取）
+    std::string ResourceClass;
+    // 上次执行时每个输入的来源端口和版本号，和本次不同时说明输入发生了变化
+    std::vector<std::pair<uintptr_t, uint64_t>> LastInputVersions;
+    // 执行耗时的指数移动平均（毫秒），用于估计关键路径，0 表示还没有成功执行过
+    double AverageExecuteMs = 0;
+
     node_ui ui;
     std::shared_ptr<node_state_value> state_value;
     node_ast ast;
 
-    Node(int id, const char *name, ImColor color = ImColor(255, 255, 255)) : ID(id), Name(name), Color(color), Type(NodeType::Blueprint), Size(0, 0)
+    Node(int id, const char *name, ImColor color = ImColor(255, 255, 255)) : ID(id), Name(name), TypeName(name), Color(color), Type(NodeType::Blueprint), Size(0, 0)
     {
     }
     // 三五法则
@@ -395,6 +526,7 @@ struct Node
     {
         ID = node.ID;
         Name = node.Name;
+        TypeName = node.TypeName;
         Inputs = node.Inputs;
         Outputs = node.Outputs;
         Color = node.Color;
@@ -404,12 +536,20 @@ struct Node
         State = node.State;
         SavedState = node.SavedState;
         OnExecute = node.OnExecute;
+        OnPointwise = node.OnPointwise;
+        OnLocal = node.OnLocal;
         LastExecuteResult = node.LastExecuteResult;
         BeginExecuteTime = node.BeginExecuteTime;
         EndExecuteTime = node.EndExecuteTime;
         ExecuteTime = node.ExecuteTime;
         IsRunning.store(node.IsRunning.load());
         RunningThreadId.store(node.RunningThreadId.load());
+        AlwaysExecute = node.AlwaysExecute;
+        Pinned = node.Pinned;
+        ResourceClass = node.ResourceClass;
+        Dirty.store(node.Dirty.load());
+        LastInputVersions = node.LastInputVersions;
+        AverageExecuteMs = node.AverageExecuteMs;
         ui = node.ui;
         state_value = node.state_value;
         ast = node.ast;
@@ -420,6 +560,7 @@ struct Node
         {
             ID = node.ID;
             Name = node.Name;
+            TypeName = node.TypeName;
             Inputs = node.Inputs;
             Outputs = node.Outputs;
             Color = node.Color;
@@ -429,12 +570,20 @@ struct Node
             State = node.State;
             SavedState = node.SavedState;
             OnExecute = node.OnExecute;
+            OnPointwise = node.OnPointwise;
+            OnLocal = node.OnLocal;
             LastExecuteResult = node.LastExecuteResult;
             BeginExecuteTime = node.BeginExecuteTime;
             EndExecuteTime = node.EndExecuteTime;
             ExecuteTime = node.ExecuteTime;
             IsRunning.store(node.IsRunning.load());
             RunningThreadId.store(node.RunningThreadId.load());
+            AlwaysExecute = node.AlwaysExecute;
+            Pinned = node.Pinned;
+            ResourceClass = node.ResourceClass;
+            Dirty.store(node.Dirty.load());
+            LastInputVersions = node.LastInputVersions;
+            AverageExecuteMs = node.AverageExecuteMs;
             ui = node.ui;
             state_value = node.state_value;
             ast = node.ast;
@@ -445,6 +594,7 @@ struct Node
     {
         ID = node.ID;
         Name = std::move(node.Name);
+        TypeName = std::move(node.TypeName);
         Inputs = std::move(node.Inputs);
         Outputs = std::move(node.Outputs);
         Color = node.Color;
@@ -454,12 +604,20 @@ struct Node
         State = std::move(node.State);
         SavedState = std::move(node.SavedState);
         OnExecute = node.OnExecute;
+        OnPointwise = node.OnPointwise;
+        OnLocal = node.OnLocal;
         LastExecuteResult = node.LastExecuteResult;
         BeginExecuteTime = node.BeginExecuteTime;
         EndExecuteTime = node.EndExecuteTime;
         ExecuteTime = node.ExecuteTime;
         IsRunning.store(node.IsRunning.load());
         RunningThreadId.store(node.RunningThreadId.load());
+        AlwaysExecute = node.AlwaysExecute;
+        Pinned = node.Pinned;
+        ResourceClass = node.ResourceClass;
+        Dirty.store(node.Dirty.load());
+        LastInputVersions = std::move(node.LastInputVersions);
+        AverageExecuteMs = node.AverageExecuteMs;
         ui = node.ui;
         state_value = node.state_value;
         ast = node.ast;
@@ -470,6 +628,7 @@ struct Node
         {
             ID = node.ID;
             Name = std::move(node.Name);
+            TypeName = std::move(node.TypeName);
             Inputs = std::move(node.Inputs);
             Outputs = std::move(node.Outputs);
             Color = node.Color;
@@ -479,12 +638,20 @@ struct Node
             State = std::move(node.State);
             SavedState = std::move(node.SavedState);
             OnExecute = node.OnExecute;
+            OnPointwise = node.OnPointwise;
+            OnLocal = node.OnLocal;
             LastExecuteResult = node.LastExecuteResult;
             BeginExecuteTime = node.BeginExecuteTime;
             EndExecuteTime = node.EndExecuteTime;
             ExecuteTime = node.ExecuteTime;
             IsRunning.store(node.IsRunning.load());
             RunningThreadId.store(node.RunningThreadId.load());
+            AlwaysExecute = node.AlwaysExecute;
+            Pinned = node.Pinned;
+            ResourceClass = node.ResourceClass;
+            Dirty.store(node.Dirty.load());
+            LastInputVersions = std::move(node.LastInputVersions);
+            AverageExecuteMs = node.AverageExecuteMs;
             ui = node.ui;
             state_value = node.state_value;
             ast = node.ast;
@@ -529,6 +696,38 @@ struct Node
     void execute(Graph *graph)
     {
         LastExecuteResult = OnExecuteEx(graph, this);
+        update_average_time();
+    }
+
+    // 记录执行时间
+    // 在上下文中执行时同一个节点可能在多个上下文中同时执行，耗时写入上下文，发布上下文时再写入节点
+    void record_execute_time(std::chrono::steady_clock::time_point begin, std::chrono::steady_clock::time_point end)
+    {
+        if (current_context)
+        {
+            set_context_execute_time(current_context, ID, end - begin);
+            return;
+        }
+        BeginExecuteTime = begin;
+        EndExecuteTime = end;
+        ExecuteTime = end - begin;
+    }
+
+    void update_average_time()
+    {
+        if (ExecuteTime)
+            update_average_time(*ExecuteTime);
+    }
+
+    void update_average_time(std::chrono::steady_clock::duration time)
+    {
+        // 出错的执行通常提前返回，不计入平均耗时
+        if (!LastExecuteResult.has_error())
+        {
+            constexpr double alpha = 0.2;
+            double ms = std::chrono::duration<double, std::milli>(time).count();
+            AverageExecuteMs = AverageExecuteMs == 0 ? ms : alpha * ms + (1 - alpha) * AverageExecuteMs;
+        }
     }
 
     bool is_running()
@@ -555,6 +754,11 @@ struct Node
     }
 };
 
+inline bool Pin::use_fingerprint() const
+{
+    return NodeWorldGlobal::fingerprint_values || (Node && Node->AlwaysExecute);
+}
+
 struct Link
 {
     ed::LinkId ID;
@@ -574,6 +778,256 @@ struct Link
     }
 };
 
+// 执行上下文：一次执行中所有端口的值和节点的执行结果
+// 图的拓扑和节点的执行函数是共享的，每个上下文各自保存值，同一个图的多个上下文可以同时执行
+// 流式执行的每一帧也是一个上下文，节点从自己所处理的帧中读取上游的输出
+struct execution_plan;
+struct execution_context
+{
+    // 按执行计划执行时，计划中节点的输出写入按槽展开的数组（槽的编号同 execution_plan::output_base）
+    // 每个槽只由所属的节点写入，读取它的节点在上游结束后才开始，读写槽不需要加锁
+    struct slot_value
+    {
+        ed::PinId id;
+        shared_port_value value;
+        bool has_value = false;
+    };
+    std::vector<slot_value> slots;
+    // 槽对应的执行计划，只用于比较，不访问
+    const execution_plan *plan = nullptr;
+
+    // 其余的值按端口 ID 保存：覆盖没有连线的输入、单独执行一个节点时的上游输出、执行中新增的端口
+    std::mutex mutex;
+    std::unordered_map<uintptr_t, shared_port_value> values;
+    std::unordered_map<uintptr_t, ExecuteResult> results;
+    std::unordered_map<uintptr_t, std::chrono::steady_clock::duration> execute_times;
+
+    // 按执行计划开始执行前调用，槽的数量为计划中输出的总数
+    void bind(const execution_plan *value, size_t slot_count)
+    {
+        plan = value;
+        slots.assign(slot_count, slot_value());
+    }
+
+    void set(ed::PinId id, const shared_port_value &value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        values[id.Get()] = value;
+    }
+
+    void set_slot(size_t slot, ed::PinId id, const shared_port_value &value)
+    {
+        auto &target = slots[slot];
+        target.id = id;
+        target.value = value;
+        target.has_value = true;
+    }
+
+    template <typename T>
+    bool get_slot(size_t slot, T &value)
+    {
+        if (slot >= slots.size() || !slots[slot].has_value || !std::holds_alternative<T>(*slots[slot].value))
+            return false;
+        value = std::get<T>(*slots[slot].value);
+        return true;
+    }
+
+    template <typename T>
+    bool get_slot(size_t slot, shared_value<T> &value)
+    {
+        return slot < slots.size() && slots[slot].has_value && value.assign(slots[slot].value);
+    }
+
+    template <typename T>
+    bool get(ed::PinId id, T &value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = values.find(id.Get());
+        if (it == values.end() || !std::holds_alternative<T>(*it->second))
+            return false;
+        value = std::get<T>(*it->second);
+        return true;
+    }
+
+    template <typename T>
+    bool get(ed::PinId id, shared_value<T> &value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = values.find(id.Get());
+        return it != values.end() && value.assign(it->second);
+    }
+
+    void set_result(ed::NodeId id, const ExecuteResult &result)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        results[id.Get()] = result;
+    }
+
+    ExecuteResult get_result(ed::NodeId id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = results.find(id.Get());
+        return it == results.end() ? ExecuteResult() : it->second;
+    }
+
+    void set_execute_time(ed::NodeId id, std::chrono::steady_clock::duration time)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        execute_times[id.Get()] = time;
+    }
+
+    std::optional<std::chrono::steady_clock::duration> get_execute_time(ed::NodeId id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = execute_times.find(id.Get());
+        if (it == execute_times.end())
+            return std::nullopt;
+        return it->second;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &slot : slots)
+            slot = slot_value();
+        values.clear();
+        results.clear();
+        execute_times.clear();
+    }
+};
+
+inline void set_context_execute_time(execution_context *context, ed::NodeId id, std::chrono::steady_clock::duration time)
+{
+    context->set_execute_time(id, time);
+}
+
+// 编译后的执行计划：按拓扑排序的节点，以及每个输入的来源
+// 来源用上游节点在计划中的下标和输出端口序号表示，执行时不再按 ID 查找连线和端口
+// 图的节点或连线变化后重新编译
+struct execution_plan
+{
+    static constexpr size_t no_source = std::numeric_limits<size_t>::max();
+
+    struct input_slot
+    {
+        size_t node = no_source;
+        size_t pin = 0;
+        ed::LinkId link;
+    };
+
+    std::vector<Node *> nodes;
+    // 每个节点每个输入的来源，没有连线时 node 为 no_source
+    std::vector<std::vector<input_slot>> inputs;
+    // 每个节点的后继节点（下标），同一对节点之间有多条连线时会出现多次
+    std::vector<std::vector<size_t>> successors;
+    // 每个节点的前驱连线数量
+    std::vector<int> indegree;
+    // 拓扑序，环上的节点和它们的下游节点永远不会就绪，不在其中
+    std::vector<size_t> order;
+    enum class fusion
+    {
+        // 逐像素运算一次遍历
+        pointwise,
+        // 局部运算按块带邻域执行
+        tiled,
+    };
+    // 融合的节点链：链中除最后一个以外的节点记录链尾的下标，不单独执行，其余为 no_source
+    std::vector<size_t> fused_tail;
+    // 链尾节点对应的整条链（从头到尾），由链尾一次执行，没有融合时为空
+    std::vector<std::vector<size_t>> fused_chains;
+    // 链尾节点对应的融合方式
+    std::vector<fusion> fused_kind;
+
+    // 低内存执行：输出按节点展开成连续的槽，output_base[i] 是节点 i 第一个输出的槽
+    std::vector<size_t> output_base;
+    // 每个槽被多少个节点读取，读取它的节点都结束后可以释放
+    std::vector<int> output_readers;
+    // 不能释放的槽：不是图像、没有读者、所属节点或某个读者被固定
+    std::vector<bool> output_keep;
+    // 每个节点读取的槽（去重），被融合的节点的读取计入链尾
+    std::vector<std::vector<size_t>> reads;
+
+    bool is_fused_member(size_t index) const
+    {
+        return fused_tail[index] != no_source;
+    }
+
+    // 输入连接的上游输出端口，没有连线时为空
+    // 节点执行时可能增删自己的端口，按序号取端口时检查范围
+    Pin *source_pin(size_t node, size_t input) const
+    {
+        if (input >= inputs[node].size())
+            return nullptr;
+        auto &slot = inputs[node][input];
+        if (slot.node == no_source || slot.pin >= nodes[slot.node]->Outputs.size())
+            return nullptr;
+        return &nodes[slot.node]->Outputs[slot.pin];
+    }
+};
+
+// 当前线程正在按执行计划执行的节点，get_value 通过它直接取得输入的来源
+struct plan_cursor
+{
+    const execution_plan *plan = nullptr;
+    size_t index = 0;
+};
+inline thread_local plan_cursor current_plan_cursor;
+
+// 正在按执行计划执行的节点写自己的输出时写入上下文的槽，其他端口按 ID 写入
+inline void set_context_value(execution_context *context, Pin *pin, const shared_port_value &value)
+{
+    auto &cursor = current_plan_cursor;
+    if (cursor.plan && cursor.plan == context->plan && pin->Node == cursor.plan->nodes[cursor.index])
+    {
+        auto &outputs = pin->Node->Outputs;
+        size_t pin_index = pin - outputs.data();
+        size_t slot = cursor.plan->output_base[cursor.index] + pin_index;
+        // 节点执行时可能新增输出，超出计划中的槽时按 ID 保存
+        if (pin >= outputs.data() && pin_index < outputs.size() && slot < cursor.plan->output_base[cursor.index + 1])
+        {
+            context->set_slot(slot, pin->ID, value);
+            return;
+        }
+    }
+    context->set(pin->ID, value);
+}
+
+// 一次执行的取消令牌
+// 有新的执行请求或超过执行期限时取消，调度器不再开始新的节点，耗时的节点在循环中自行检查
+struct cancel_token
+{
+    std::atomic<bool> cancelled = false;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+
+    void cancel()
+    {
+        cancelled = true;
+    }
+
+    bool is_deadline_exceeded() const
+    {
+        return deadline && std::chrono::steady_clock::now() >= *deadline;
+    }
+
+    bool is_cancelled() const
+    {
+        return cancelled || is_deadline_exceeded();
+    }
+
+    std::string reason() const
+    {
+        return cancelled ? "执行已取消" : "超过执行期限";
+    }
+};
+
+// 当前线程正在执行的节点所属执行的取消令牌，单独执行节点时为空
+inline thread_local cancel_token *current_cancel_token = nullptr;
+
+inline bool is_execute_cancelled()
+{
+    return current_cancel_token && current_cancel_token->is_cancelled();
+}
+
 struct GraphUi
 {
     Graph *graph;
@@ -600,6 +1054,10 @@ struct graph_algorithm
     std::vector<cycle> find_all_cycles();
 };
 
+// 定义在文件末尾，融合执行时读取链头节点的输入
+template <typename T>
+static ExecuteResult get_value(Graph *graph, Pin &input, T &value);
+
 struct Graph
 {
     std::vector<Node> Nodes;
@@ -639,6 +1097,7 @@ struct Graph
     {
         for (auto &node : this->Nodes)
             build_node(&node);
+        invalidate_index();
     }
 
     struct ExectureEnv
@@ -646,14 +1105,17 @@ struct Graph
         std::atomic<bool> isRunning = false;
         std::atomic<bool> needRunning = false; // 在下一次循环中是否需要执行
         std::atomic<bool> isStoped = false;    // 是否已经销毁
-        std::map<ed::NodeId, std::chrono::steady_clock::time_point> nodeBeginExecuteTime;
-        std::map<ed::NodeId, std::chrono::steady_clock::time_point> nodeEndExecuteTime;
-        std::map<ed::NodeId, std::chrono::steady_clock::duration> nodeExecuteTime;
+
+        // 执行结束时清除 isRunning，执行抛出异常时也要清除，否则之后的执行都无法开始
+        struct running_guard
+        {
+            std::atomic<bool> &flag;
+            ~running_guard() { flag = false; }
+        };
         std::optional<std::chrono::steady_clock::time_point> BeginExecuteTime;
         std::optional<std::chrono::steady_clock::time_point> EndExecuteTime;
         std::optional<std::chrono::steady_clock::duration> ExecuteTime;
         std::atomic<double> all_execute_time = 0;
-        std::list<ed::NodeId> nodeBeginExecuteList;
         std::future<void> future; // 异步执行
         // need inint
         void execture_stopwatch()
@@ -664,253 +1126,1432 @@ struct Graph
             ExecuteTime = std::chrono::duration_cast<std::chrono::milliseconds>(*EndExecuteTime - *BeginExecuteTime);
             all_execute_time = static_cast<double>(ExecuteTime->count());
         };
-        Graph *graph;
-        Application *app;
+        Graph *graph = nullptr;
+        Application *app = nullptr;
 
         std::map<int, Node *> sorted_nodes;
 
-        void ExecuteNode(Node *node)
+        // 返回节点的输出是否和结果缓存共享
+        bool ExecuteNode(Node *node)
         {
-            if (node->has_execute_mothod())
+            if (!node->has_execute_mothod())
+                return false;
+            // 有副作用的节点和没有输出的节点不使用缓存
+            if (!use_result_cache || node->AlwaysExecute || node->Outputs.empty())
+            {
+                node->execute(graph);
+                return false;
+            }
+            // 键在执行前计算，有些节点执行时会修改自己的输入
+            auto key = get_result_cache_key(node);
+            if (!key)
+            {
                 node->execute(graph);
+                return false;
+            }
+            auto outputs = result_cache.find(*key);
+            if (outputs && outputs->size() == node->Outputs.size())
+            {
+                for (size_t i = 0; i < outputs->size(); i++)
+                    node->Outputs[i].SetPortValue((*outputs)[i]);
+                node->LastExecuteResult = ExecuteResult::Success();
+                result_cache.record(node->ID.Get(), true);
+                return true;
+            }
+            result_cache.record(node->ID.Get(), false);
+            node->execute(graph);
+            if (node->LastExecuteResult.has_error() || !node->ExecuteTime)
+                return false;
+            // 执行很快的节点缓存的收益小于计算哈希的开销
+            if (std::chrono::duration<double, std::milli>(*node->ExecuteTime).count() < result_cache_min_time_ms)
+                return false;
+            std::vector<shared_port_value> values;
+            for (auto &output : node->Outputs)
+                values.push_back(output.Value);
+            result_cache.insert(*key, values);
+            return true;
         }
 
-        void ExecuteNodes()
+        // 结果缓存的键：节点类型名称和每个输入的值的哈希，输入有连接时使用上游输出端口的值
+        std::optional<node_result_cache::key_t> get_result_cache_key(Node *node)
         {
-            // 每个节点有一个依赖表，记录依赖的节点
-            std::map<Node *, std::vector<Node *>> depend_map;
-            // 每个节点都有一个关联表，记录依赖它的节点
-            std::map<Node *, std::set<Node *>> relate_map;
-            // 每一个节点有一个是否成功运行完毕的标志
-            std::map<Node *, bool> node_run_map;
-            // 如果节点运行错误，记录错误节点和它的关联节点
-            std::set<Node *> error_and_relate_nodes;
-            // 需要运行的所有节点
-            std::list<Node *> need_run_nodes;
-            // 运行结束标志
-            bool is_end = false;
-            // 理论上运行的循环次数不会超过节点数
-            size_t max_loop_limit = graph->Nodes.size();
-            // 运行循环次数
-            int loop_count = 0;
-
-            // 需要运行所有节点
-            for (auto &node : graph->Nodes)
-                need_run_nodes.push_back(&node);
-
-            // 生成依赖表
+            std::vector<uint64_t> parts;
+            parts.push_back(hash_bytes(node->TypeName.data(), node->TypeName.size()));
+            for (auto &input : node->Inputs)
             {
-                // 根据输入连接生成依赖表
-                for (auto &node : graph->Nodes)
-                {
-                    for (auto &input : node.Inputs)
-                    {
-                        if (graph->IsPinLinked(input.ID) == false)
-                            continue;
-                        auto links = graph->FindPinLinks(input.ID);
-                        for (auto &link : links)
-                        {
-                            if (link->is_self_link())
-                                continue;
-                            auto beginpin = graph->FindPin(link->StartPinID);
-                            if (beginpin == nullptr)
-                                continue;
-                            if (beginpin->Kind != PinKind::Output)
-                                continue;
-                            auto beginnode = beginpin->Node;
-                            if (beginnode == nullptr)
-                                continue;
-                            depend_map[&node].push_back(beginnode);
-                        }
-                    }
-                }
-                // 根据输出连接生成关联表
-                for (auto &node : graph->Nodes)
+                Pin *pin = &input;
+                if (auto link = graph->FindPinLink(input.ID))
                 {
-                    for (auto &output : node.Outputs)
-                    {
-                        if (graph->IsPinLinked(output.ID) == false)
-                            continue;
-                        auto links = graph->FindPinLinks(output.ID);
-                        for (auto &link : links)
-                        {
-                            // FIX: 自连接会导致运行不到
-                            if (link->is_self_link())
-                                continue;
-                            auto endpin = graph->FindPin(link->EndPinID);
-                            if (endpin == nullptr)
-                                continue;
-                            if (endpin->Kind != PinKind::Input)
-                                continue;
-                            auto endnode = endpin->Node;
-                            if (endnode == nullptr)
-                                continue;
-                            relate_map[&node].insert(endnode);
-                        }
-                    }
+                    auto start_pin = graph->FindPin(link->StartPinID);
+                    if (start_pin && start_pin->Kind == PinKind::Output)
+                        pin = start_pin;
                 }
+                auto hash = result_cache.get_pin_hash(pin->ID.Get(), pin->Version, *pin->Value);
+                if (!hash)
+                    return std::nullopt;
+                parts.push_back(*hash);
             }
+            return node_result_cache::make_key(parts);
+        }
 
-            while (!is_end)
-            {
-                const auto get_depend_over_nodes = [&need_run_nodes, &depend_map, &node_run_map, error_and_relate_nodes]()
-                {
-                    std::vector<Node *> nodes;
-                    for (auto &node : need_run_nodes)
-                    {
-                        // 跳过已经运行过的节点
-                        if (node_run_map[node] == true)
-                            continue;
-                        // 跳过在[错误和关联节点]中的节点
-                        if (error_and_relate_nodes.find(node) != error_and_relate_nodes.end())
-                            continue;
-
-                        auto &depend_nodes = depend_map[node];
-                        // 如果没有依赖或者依赖节点都已经运行完毕
-                        if (depend_nodes.size() == 0)
-                        {
-                            nodes.push_back(node);
-                            continue;
-                        }
-                        bool is_all_depend_over = true;
-                        for (auto &depend : depend_nodes)
-                        {
-                            if (node_run_map[depend] == false)
-                            {
-                                is_all_depend_over = false;
-                                break;
-                            }
-                        }
-                        if (is_all_depend_over)
-                        {
-                            nodes.push_back(node);
-                        }
-                    }
-
-                    return nodes;
-                };
-                // 获取依赖节点都已经运行完毕的节点
-                auto can_run_nodes = get_depend_over_nodes();
-                // 没有可以运行的节点，终止循环
-                if (can_run_nodes.size() == 0)
-                {
-                    is_end = true;
-                    break;
-                }
-                // 并行执行节点
-                std::vector<std::future<void>> futures;
-                for (auto &node : can_run_nodes)
-                {
-                    sorted_nodes.insert({(int)sorted_nodes.size(), node});
-                    // 添加到运行节点列表
-                    futures.push_back(std::async(std::launch::async, [this, node]
-                                                 { ExecuteNode(node); }));
-                }
+        // 结果缓存，默认关闭
+        node_result_cache result_cache;
+        std::atomic<bool> use_result_cache = false;
+        // 执行耗时低于该值的节点不缓存结果
+        double result_cache_min_time_ms = 1.0;
 
-                // debug 打印本次循环执行的节点
-                printf("本%d次循环执行的节点: %zd个", loop_count, can_run_nodes.size());
-                // ImGui::InsertNotification({ImGuiToastType::Info, 3000, (std::string("本次运行第") + std::to_string(loop_count) + "次循环执行的节点: " + std::to_string(can_run_nodes.size()) + "个").c_str()});
-                for (auto &node : can_run_nodes)
+        // 一次执行的调度状态，执行任务持有共享指针，保证最后一个任务结束前状态有效
+        struct schedule_state
+        {
+            std::shared_ptr<const execution_plan> plan;
+            // 每个节点还没有执行完毕的前驱连线数量
+            std::unique_ptr<std::atomic<int>[]> indegree;
+            // 前驱节点出错或被跳过时，节点也被跳过
+            std::unique_ptr<std::atomic<bool>[]> skip;
+            // 还没有结束的节点数量
+            std::atomic<size_t> remaining = 0;
+            // 关键路径优先：每个节点的向上秩（到汇点的最长预计耗时），就绪节点按秩从大到小执行
+            // 为空时不排序，就绪节点直接提交到线程池
+            std::vector<double> rank;
+            std::mutex ready_mutex;
+            std::vector<std::pair<double, size_t>> ready;
+            // 在上下文中执行时端口的值和执行结果写入上下文，为空时直接在图上执行
+            std::shared_ptr<execution_context> context;
+            // 本次执行的取消令牌和因取消而没有执行完的节点
+            std::shared_ptr<cancel_token> token;
+            std::mutex cancelled_mutex;
+            std::vector<Node *> cancelled;
+            // 低内存执行：每个输出槽还没有结束的读者数量，为空时不释放
+            std::unique_ptr<std::atomic<int>[]> readers_left;
+            // 输出来自结果缓存或已放入缓存的节点，缓存持有同一份图像，释放端口不能减少内存
+            std::unique_ptr<std::atomic<bool>[]> shared_with_cache;
+            // 端口持有的图像字节数和本次执行中的峰值
+            std::atomic<int64_t> resident_bytes = 0;
+            std::atomic<int64_t> peak_resident_bytes = 0;
+            std::atomic<int64_t> released_bytes = 0;
+            // 记录执行轨迹或性能数据时每个节点进入就绪队列的时间，都不记录时为空
+            bool traced = false;
+            bool profiled = false;
+            uint64_t trace_run = 0;
+            std::unique_ptr<std::chrono::steady_clock::time_point[]> ready_time;
+
+            void add_resident(int64_t bytes)
+            {
+                auto current = resident_bytes += bytes;
+                auto peak = peak_resident_bytes.load();
+                while (current > peak && !peak_resident_bytes.compare_exchange_weak(peak, current))
                 {
-                    printf("%d ", static_cast<int>(reinterpret_cast<int64>(node->ID.AsPointer())));
                 }
-                printf("\n");
-
-                // 等待所有节点运行完毕
-                for (auto &future : futures)
-                    future.get();
+            }
 
-                // 标记节点已经运行完毕
-                for (auto &node : can_run_nodes)
-                    node_run_map[node] = true;
+            void add_cancelled(Node *node)
+            {
+                std::lock_guard<std::mutex> lock(cancelled_mutex);
+                cancelled.push_back(node);
+            }
+        };
 
-                // 如果节点运行错误，记录错误节点
-                std::set<Node *> error_nodes;
-                for (auto &node : can_run_nodes)
-                {
-                    if (node->LastExecuteResult.has_error())
-                        error_nodes.insert(node);
-                }
+        // 根据连线生成执行计划，O(V+E)
+        std::shared_ptr<execution_plan> compile_plan()
+        {
+            auto plan = std::make_shared<execution_plan>();
+            const size_t count = graph->Nodes.size();
+
+            // 端口所属节点下标和端口序号
+            std::unordered_map<uintptr_t, std::pair<size_t, size_t>> input_owner;
+            std::unordered_map<uintptr_t, std::pair<size_t, size_t>> output_owner;
+            plan->inputs.resize(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                auto &node = graph->Nodes[i];
+                plan->nodes.push_back(&node);
+                plan->inputs[i].resize(node.Inputs.size());
+                for (size_t k = 0; k < node.Inputs.size(); k++)
+                    input_owner[node.Inputs[k].ID.Get()] = {i, k};
+                for (size_t k = 0; k < node.Outputs.size(); k++)
+                    output_owner[node.Outputs[k].ID.Get()] = {i, k};
+            }
+            plan->indegree.assign(count, 0);
+            plan->successors.resize(count);
+            for (auto &link : graph->Links)
+            {
+                // FIX: 自连接会导致运行不到
+                if (link.is_self_link())
+                    continue;
+                auto begin = output_owner.find(link.StartPinID.Get());
+                auto end = input_owner.find(link.EndPinID.Get());
+                if (begin == output_owner.end() || end == input_owner.end())
+                    continue;
+                auto [begin_node, begin_pin] = begin->second;
+                auto [end_node, end_pin] = end->second;
+                plan->successors[begin_node].push_back(end_node);
+                // 一个输入有多条连线时和 FindPinLink 一样取第一条
+                auto &slot = plan->inputs[end_node][end_pin];
+                if (slot.node == execution_plan::no_source)
+                    slot = {begin_node, begin_pin, link.ID};
+                plan->indegree[end_node]++;
+            }
 
-                // 从【需要运行的节点】中删除已经运行完成的
-                for (auto &node : can_run_nodes)
-                {
-                    need_run_nodes.remove(node);
-                }
+            std::vector<int> pending = plan->indegree;
+            for (size_t i = 0; i < count; i++)
+                if (pending[i] == 0)
+                    plan->order.push_back(i);
+            for (size_t k = 0; k < plan->order.size(); k++)
+                for (auto successor : plan->successors[plan->order[k]])
+                    if (--pending[successor] == 0)
+                        plan->order.push_back(successor);
+
+            plan->fused_tail.assign(count, execution_plan::no_source);
+            plan->fused_chains.resize(count);
+            plan->fused_kind.assign(count, execution_plan::fusion::pointwise);
+            if (fuse_pointwise)
+                fuse_chains(*plan, execution_plan::fusion::pointwise, [](Node *node)
+                            { return static_cast<bool>(node->OnPointwise); });
+            if (tiled_execution)
+                fuse_chains(*plan, execution_plan::fusion::tiled, [](Node *node)
+                            { return static_cast<bool>(node->OnLocal); });
+            compute_liveness(*plan);
+            return plan;
+        }
 
-                // 将[错误节点]和[关联节点]加入到[错误和关联节点]中
-                for (auto &error_node : error_nodes)
+        // 每个输出的读者数量，在融合之后计算：被融合的节点在链尾执行时才读取输入
+        static void compute_liveness(execution_plan &plan)
+        {
+            const size_t count = plan.nodes.size();
+            plan.output_base.assign(count + 1, 0);
+            for (size_t i = 0; i < count; i++)
+                plan.output_base[i + 1] = plan.output_base[i] + plan.nodes[i]->Outputs.size();
+            const size_t slots = plan.output_base[count];
+            plan.output_readers.assign(slots, 0);
+            plan.output_keep.assign(slots, false);
+            plan.reads.assign(count, {});
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t reader = plan.is_fused_member(i) ? plan.fused_tail[i] : i;
+                for (auto &slot : plan.inputs[i])
                 {
-                    error_and_relate_nodes.insert(error_node);
-                    for (auto &relate_node : relate_map[error_node])
+                    if (slot.node == execution_plan::no_source)
+                        continue;
+                    size_t id = plan.output_base[slot.node] + slot.pin;
+                    auto &reads = plan.reads[reader];
+                    if (std::find(reads.begin(), reads.end(), id) == reads.end())
                     {
-                        error_and_relate_nodes.insert(relate_node);
+                        reads.push_back(id);
+                        plan.output_readers[id]++;
                     }
+                    if (plan.nodes[i]->Pinned)
+                        plan.output_keep[id] = true;
                 }
-
-                // 循环次数超过限制，终止循环
-                if (loop_count++ > max_loop_limit)
+            }
+            for (size_t i = 0; i < count; i++)
+                for (size_t k = 0; k < plan.nodes[i]->Outputs.size(); k++)
                 {
-                    is_end = true;
-                    break;
+                    size_t id = plan.output_base[i] + k;
+                    if (plan.nodes[i]->Pinned || plan.nodes[i]->Outputs[k].Type != PinType::Image || plan.output_readers[id] == 0)
+                        plan.output_keep[id] = true;
                 }
-            }
         }
 
-        bool is_stoped()
+        // 找出连续的可融合节点：上游的图像输出只连接到下游的图像输入，并且上游没有其他连线
+        // 中间结果没有其他读者，可以不生成，整条链由链尾一次完成
+        static void fuse_chains(execution_plan &plan, execution_plan::fusion kind, const std::function<bool(Node *)> &can_fuse)
         {
-            return isStoped.load();
+            const size_t count = plan.nodes.size();
+            auto is_candidate = [&](size_t index)
+            {
+                auto node = plan.nodes[index];
+                if (plan.is_fused_member(index) || !plan.fused_chains[index].empty())
+                    return false;
+                return can_fuse(node) && !node->Inputs.empty() && node->Outputs.size() == 1 &&
+                       node->Inputs[0].Type == PinType::Image && node->Outputs[0].Type == PinType::Image;
+            };
+            std::vector<size_t> next(count, execution_plan::no_source);
+            std::vector<bool> has_previous(count, false);
+            for (size_t i = 0; i < count; i++)
+            {
+                if (!is_candidate(i))
+                    continue;
+                auto &slot = plan.inputs[i][0];
+                if (slot.node == execution_plan::no_source || slot.pin != 0 || !is_candidate(slot.node))
+                    continue;
+                if (plan.successors[slot.node].size() != 1)
+                    continue;
+                next[slot.node] = i;
+                has_previous[i] = true;
+            }
+            for (size_t head = 0; head < count; head++)
+            {
+                if (has_previous[head] || next[head] == execution_plan::no_source)
+                    continue;
+                std::vector<size_t> chain{head};
+                while (next[chain.back()] != execution_plan::no_source)
+                    chain.push_back(next[chain.back()]);
+                auto tail = chain.back();
+                for (size_t k = 0; k + 1 < chain.size(); k++)
+                    plan.fused_tail[chain[k]] = tail;
+                plan.fused_chains[tail] = std::move(chain);
+                plan.fused_kind[tail] = kind;
+            }
         }
 
-        void need_stop()
+        // 拓扑没有变化时沿用上次编译的执行计划
+        std::shared_ptr<const execution_plan> get_plan()
         {
-            isStoped.store(true);
+            plan_key_t key{graph->get_topology_version(), graph->Nodes.data(), graph->Nodes.size(), graph->Links.data(), graph->Links.size(), fuse_pointwise, tiled_execution};
+            std::lock_guard<std::mutex> lock(plan_mutex);
+            if (!cached_plan || !(plan_key == key))
+            {
+                auto begin = std::chrono::steady_clock::now();
+                cached_plan = compile_plan();
+                plan_key = key;
+                plan_compile_count++;
+                if (trace_enabled)
+                {
+                    auto chains = std::count_if(cached_plan->fused_chains.begin(), cached_plan->fused_chains.end(), [](const std::vector<size_t> &chain)
+                                                { return !chain.empty(); });
+                    trace.complete("编译执行计划", "scheduler", begin, std::chrono::steady_clock::now(), {{"nodes", cached_plan->nodes.size()}, {"fused_chains", static_cast<size_t>(chains)}});
+                }
+            }
+            return cached_plan;
         }
 
-        void need_execute()
+        // 执行计划编译的次数
+        std::atomic<size_t> plan_compile_count = 0;
+        // 融合连续的逐像素节点，被融合的中间节点不再生成输出
+        // 中间节点的输出在预览和其他连线上会变成旧值，默认关闭，由使用者按图选择开启
+        std::atomic<bool> fuse_pointwise = false;
+        // 融合连续的局部运算节点，宽或高超过块大小的图像按块带邻域并行执行
+        // 和逐像素融合一样中间节点不再生成输出，默认关闭
+        std::atomic<bool> tiled_execution = false;
+        std::atomic<int> tile_size = 512;
+
+        std::optional<cv::Mat> run_pointwise_chain(const execution_plan &plan, const std::vector<size_t> &chain, const cv::Mat &image)
         {
-            needRunning = true;
-            async_execute();
+            if (image.empty() || !is_pointwise_depth(image.depth()))
+                return std::nullopt;
+            std::vector<pointwise_op> ops;
+            for (auto member : chain)
+            {
+                auto node = plan.nodes[member];
+                auto op = node->OnPointwise(graph, node);
+                if (!op)
+                    return std::nullopt;
+                ops.push_back(*op);
+            }
+            cv::Mat result = plan.nodes[chain.back()]->Outputs[0].take_image_buffer();
+            apply_pointwise(image, ops, result);
+            return result;
         }
 
-        void async_execute()
+        std::optional<cv::Mat> run_tiled_chain(const execution_plan &plan, const std::vector<size_t> &chain, const cv::Mat &image)
         {
-            // 如果没有执行过，或者需要执行，且没有正在执行
-            if (needRunning && !isRunning)
-            {
-                const auto execute_and_release = [this](Graph *graph)
-                {
-                    execture_stopwatch();
-                    isRunning = false;
-                    needRunning = false;
-                };
-                isRunning = true;
-                future = std::async(std::launch::async, execute_and_release, graph);
-            }
-            if (future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            // 一块就能放下的图像直接逐个执行
+            const int tile = tile_size;
+            if (image.empty() || tile <= 0 || (image.cols <= tile && image.rows <= tile))
+                return std::nullopt;
+            std::vector<local_op> ops;
+            int type = image.type();
+            for (auto member : chain)
             {
-                future.get();
+                auto node = plan.nodes[member];
+                auto op = node->OnLocal(graph, node, type);
+                if (!op || !is_tileable_border(op->border_type))
+                    return std::nullopt;
+                if (op->ddepth >= 0)
+                    type = CV_MAKETYPE(op->ddepth, CV_MAT_CN(type));
+                ops.push_back(std::move(*op));
             }
+            cv::Mat result = plan.nodes[chain.back()]->Outputs[0].take_image_buffer();
+            apply_tiled(image, ops, tile, result);
+            return result;
         }
-    };
-    ExectureEnv env;
 
-    Node *FindNode(ed::NodeId id)
-    {
-        for (auto &node : Nodes)
-            if (node.ID == id)
-                return &node;
+        // 执行一条融合的节点链，结果写入链尾节点的输出
+        // 输入图像或某个节点的参数不支持融合时，按顺序逐个执行链中的节点
+        ExecuteResult execute_fused(const execution_plan &plan, size_t index)
+        {
+            auto &chain = plan.fused_chains[index];
+            auto head = plan.nodes[chain.front()];
+            auto tail = plan.nodes[index];
+            tail->RunningThreadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
+            auto begin = std::chrono::steady_clock::now();
+            tail->IsRunning = true;
+            auto result = [&]() -> ExecuteResult
+            {
+                try
+                {
+                    // 链头的输入按链头在计划中的位置读取
+                    cv::Mat image;
+                    current_plan_cursor = {&plan, chain.front()};
+                    get_value(graph, head->Inputs[0], image);
+                    current_plan_cursor = {&plan, index};
+                    auto fused = plan.fused_kind[index] == execution_plan::fusion::tiled ? run_tiled_chain(plan, chain, image)
+                                                                                          : run_pointwise_chain(plan, chain, image);
+                    if (fused)
+                    {
+                        tail->Outputs[0].SetValue(*fused);
+                        return ExecuteResult::Success();
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    return ExecuteResult::ErrorNode(tail->ID, e.what());
+                }
+                // 出错时返回的错误指向出错的节点
+                // 逐个执行时每个节点按自己在计划中的位置读写端口
+                for (auto member : chain)
+                {
+                    auto node = plan.nodes[member];
+                    current_plan_cursor = {&plan, member};
+                    auto member_result = node->OnExecuteEx(graph, node);
+                    current_plan_cursor = {&plan, index};
+                    if (member_result.has_error())
+                        return member_result;
+                }
+                return ExecuteResult::Success();
+            }();
+            tail->IsRunning = false;
+            tail->record_execute_time(begin, std::chrono::steady_clock::now());
+            return result;
+        }
+
+        // 按执行计划执行一个节点：被融合的中间节点不单独执行，链尾节点执行整条链
+        ExecuteResult execute_planned(const execution_plan &plan, size_t index)
+        {
+            auto node = plan.nodes[index];
+            if (plan.is_fused_member(index))
+                return ExecuteResult::Success();
+            if (!plan.fused_chains[index].empty())
+                return execute_fused(plan, index);
+            return node->OnExecuteEx(graph, node);
+        }
+
+        void ExecuteNodes()
+        {
+            auto state = std::make_shared<schedule_state>();
+            state->plan = get_plan();
+            const size_t count = state->plan->nodes.size();
+            auto &indegree = state->plan->indegree;
+            auto &order = state->plan->order;
+            sorted_nodes.clear();
+            for (auto index : order)
+                sorted_nodes.insert({(int)sorted_nodes.size(), state->plan->nodes[index]});
+            state->token = begin_run();
+            if (order.empty())
+            {
+                end_run(*state);
+                return;
+            }
+
+            state->indegree = std::make_unique<std::atomic<int>[]>(count);
+            state->skip = std::make_unique<std::atomic<bool>[]>(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                state->indegree[i] = indegree[i];
+                state->skip[i] = false;
+            }
+            state->remaining = order.size();
+            executed_count = 0;
+            reused_count = 0;
+            predict_schedule(*state);
+
+            auto &plan = *state->plan;
+            for (auto node : plan.nodes)
+                state->resident_bytes += output_image_bytes(node);
+            state->peak_resident_bytes = state->resident_bytes.load();
+            if (low_memory)
+            {
+                const size_t slots = plan.output_readers.size();
+                state->readers_left = std::make_unique<std::atomic<int>[]>(slots);
+                for (size_t i = 0; i < slots; i++)
+                    state->readers_left[i] = plan.output_readers[i];
+                state->shared_with_cache = std::make_unique<std::atomic<bool>[]>(count);
+                for (size_t i = 0; i < count; i++)
+                    state->shared_with_cache[i] = false;
+            }
+
+            // 没有依赖的节点直接开始执行，其余节点在最后一个前驱结束时被提交
+            mat_allocation_counter::install();
+            auto allocations_before = mat_allocation_counter::instance().get_count();
+            begin_trace(*state);
+            begin_profile(*state);
+            auto begin = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; i++)
+                if (indegree[i] == 0)
+                    schedule_node(state, i);
+
+            // 等待所有节点结束，等待期间当前工作线程会帮忙执行队列中的节点
+            get_pool().wait_until([&state]()
+                                  { return state->remaining == 0; });
+            actual_makespan_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            peak_resident_bytes = static_cast<size_t>(std::max<int64_t>(state->peak_resident_bytes, 0));
+            released_bytes = static_cast<size_t>(state->released_bytes);
+            last_run_allocations = mat_allocation_counter::instance().get_count() - allocations_before;
+            if (state->profiled)
+                profile.end_run();
+            if (state->traced)
+                trace.complete("执行", "scheduler", begin, std::chrono::steady_clock::now(),
+                               {{"run", state->trace_run}, {"executed", executed_count.load()}, {"reused", reused_count.load()}, {"predicted_ms", predicted_makespan_ms.load()}, {"allocations", last_run_allocations.load()}});
+            end_run(*state);
+        }
+
+        // 执行轨迹：打开后记录每次执行中每个节点的排队等待、执行时间和输出大小，以及调度器的事件
+        std::atomic<bool> trace_enabled = false;
+        execution_trace trace;
+
+        void begin_trace(schedule_state &state)
+        {
+            if (!trace_enabled)
+                return;
+            state.traced = true;
+            state.trace_run = trace.next_run();
+            state.ready_time = std::make_unique<std::chrono::steady_clock::time_point[]>(state.plan->nodes.size());
+            trace.name_current_thread("调度线程");
+        }
+
+        // 性能记录：保存最近若干次图上执行中每个执行了的节点的耗时，沿用上次输出的节点不计入
+        // 每个节点结束时要查找类型名称并加锁写入记录，默认关闭，在性能面板中开启
+        std::atomic<bool> profiling = false;
+        execution_profile profile;
+
+        void begin_profile(schedule_state &state)
+        {
+            if (!profiling)
+                return;
+            state.profiled = true;
+            if (!state.ready_time)
+                state.ready_time = std::make_unique<std::chrono::steady_clock::time_point[]>(state.plan->nodes.size());
+            profile.begin_run();
+        }
+
+        void profile_node(schedule_state &state, size_t index, std::chrono::steady_clock::time_point start)
+        {
+            auto node = state.plan->nodes[index];
+            std::string type = "未知";
+            for (auto &[name, node_type] : nodeTypes)
+                if (node_type == node->Type)
+                {
+                    type = name;
+                    break;
+                }
+            profile.add(static_cast<uintptr_t>(node->ID.Get()), node->Name, type, state.ready_time[index], start, std::chrono::steady_clock::now());
+        }
+
+        // 同一次执行中节点的排队事件 ID 不重复，不同执行之间也不重复
+        static uint64_t trace_event_id(const schedule_state &state, size_t index)
+        {
+            return (state.trace_run << 32) | index;
+        }
+
+        void trace_node(schedule_state &state, size_t index, std::chrono::steady_clock::time_point start, const char *status)
+        {
+            auto end = std::chrono::steady_clock::now();
+            auto node = state.plan->nodes[index];
+            trace.async_end(node->Name, "queue", trace_event_id(state, index), start);
+            auto wait_us = std::chrono::duration_cast<std::chrono::microseconds>(start - state.ready_time[index]).count();
+            execution_trace::args_t args = {{"node_id", static_cast<uint64_t>(node->ID.Get())}, {"status", status}, {"queue_wait_us", wait_us}};
+            // 上下文中执行时输出写入上下文，端口中的值不是本次的输出
+            if (!state.context)
+            {
+                size_t bytes = 0;
+                for (auto &output : node->Outputs)
+                    bytes += node_result_cache::value_bytes(*output.Value);
+                args.emplace_back("output_bytes", bytes);
+            }
+            trace.complete(node->Name, "node", start, end, std::move(args));
+            if (!state.context)
+                trace.counter("图像内存", end, static_cast<double>(state.resident_bytes.load()));
+        }
+
+        void schedule_node(const std::shared_ptr<schedule_state> &state, size_t index)
+        {
+            if (state->ready_time)
+            {
+                auto now = std::chrono::steady_clock::now();
+                state->ready_time[index] = now;
+                if (state->traced)
+                    trace.async_begin(state->plan->nodes[index]->Name, "queue", trace_event_id(*state, index), now);
+            }
+            if (state->rank.empty())
+            {
+                get_pool().post([this, state, index]()
+                                { run_scheduled_node(state, index); });
+                return;
+            }
+            // 任务不绑定节点，开始运行时取出秩最大的就绪节点
+            {
+                std::lock_guard<std::mutex> lock(state->ready_mutex);
+                state->ready.emplace_back(state->rank[index], index);
+                std::push_heap(state->ready.begin(), state->ready.end());
+            }
+            get_pool().post([this, state]()
+                            {
+                                size_t next = 0;
+                                {
+                                    std::lock_guard<std::mutex> lock(state->ready_mutex);
+                                    std::pop_heap(state->ready.begin(), state->ready.end());
+                                    next = state->ready.back().second;
+                                    state->ready.pop_back();
+                                }
+                                run_scheduled_node(state, next); });
+        }
+
+        // 根据历史平均耗时估计本次执行：计算向上秩，并模拟按秩调度到工作线程上的完成时间
+        void predict_schedule(schedule_state &state)
+        {
+            auto &plan = *state.plan;
+            auto &order = plan.order;
+            const size_t count = plan.nodes.size();
+            // 输入没有变化的节点会沿用输出，耗时按 0 计算；上游会执行的节点也要执行
+            std::vector<bool> will_run(count, false);
+            for (auto index : order)
+            {
+                auto node = plan.nodes[index];
+                // 融合链的成员随链尾一起执行，耗时计入链尾
+                if (!will_run[index] && node->has_execute_mothod() && !plan.is_fused_member(index))
+                    will_run[index] = need_execute_node(node, get_input_versions(plan, index));
+                if (will_run[index])
+                    for (auto successor : plan.successors[index])
+                        will_run[successor] = true;
+            }
+            // 没有执行过的节点按已知节点的平均耗时估计
+            double known_sum = 0;
+            size_t known_count = 0;
+            for (auto node : plan.nodes)
+                if (node->AverageExecuteMs > 0)
+                {
+                    known_sum += node->AverageExecuteMs;
+                    known_count++;
+                }
+            double unknown_ms = known_count > 0 ? known_sum / known_count : 0.0;
+            std::vector<double> weight(count, 0.0);
+            for (size_t i = 0; i < count; i++)
+                if (will_run[i])
+                    weight[i] = plan.nodes[i]->AverageExecuteMs > 0 ? plan.nodes[i]->AverageExecuteMs : unknown_ms;
+
+            std::vector<double> rank(count, 0.0);
+            for (auto it = order.rbegin(); it != order.rend(); ++it)
+            {
+                double longest = 0;
+                for (auto successor : plan.successors[*it])
+                    longest = std::max(longest, rank[successor]);
+                rank[*it] = weight[*it] + longest;
+            }
+            double critical_path = 0;
+            for (auto index : order)
+                critical_path = std::max(critical_path, rank[index]);
+            critical_path_ms = critical_path;
+            predicted_makespan_ms = simulate_makespan(plan, weight, rank, get_worker_count());
+            if (critical_path_priority)
+                state.rank = std::move(rank);
+        }
+
+        // 模拟列表调度：空闲的工作线程总是取秩最大的就绪节点
+        static double simulate_makespan(const execution_plan &plan, const std::vector<double> &weight, const std::vector<double> &rank, size_t workers)
+        {
+            std::vector<int> pending = plan.indegree;
+            std::priority_queue<std::pair<double, size_t>> ready;
+            using event_t = std::pair<double, size_t>;
+            std::priority_queue<event_t, std::vector<event_t>, std::greater<event_t>> running;
+            for (size_t i = 0; i < pending.size(); i++)
+                if (pending[i] == 0)
+                    ready.emplace(rank[i], i);
+            double time = 0;
+            size_t idle = std::max<size_t>(workers, 1);
+            while (!ready.empty() || !running.empty())
+            {
+                while (idle > 0 && !ready.empty())
+                {
+                    auto index = ready.top().second;
+                    ready.pop();
+                    running.emplace(time + weight[index], index);
+                    idle--;
+                }
+                auto [finish, index] = running.top();
+                running.pop();
+                time = finish;
+                idle++;
+                for (auto successor : plan.successors[index])
+                    if (--pending[successor] == 0)
+                        ready.emplace(rank[successor], successor);
+            }
+            return time;
+        }
+
+        // 关键路径优先调度，工作线程少于就绪节点时先执行关键路径上的节点
+        std::atomic<bool> critical_path_priority = true;
+        // 上次执行预测的完成时间、关键路径长度和实际完成时间（毫秒）
+        std::atomic<double> predicted_makespan_ms = 0;
+        std::atomic<double> critical_path_ms = 0;
+        std::atomic<double> actual_makespan_ms = 0;
+
+        // 资源类别的并发限制，图上执行、上下文执行和流式执行共用
+        // 名额已满的节点排队后直接返回，名额转交给它时重新提交，不占用工作线程等待
+        resource_limiter resources;
+
+        // has_resource：节点从资源排队中恢复，已经持有资源类别的名额
+        void run_scheduled_node(const std::shared_ptr<schedule_state> &state, size_t index, bool has_resource = false)
+        {
+            auto start = std::chrono::steady_clock::now();
+            bool skipped = state->skip[index];
+            auto node = state->plan->nodes[index];
+            auto acquire = [&]()
+            {
+                if (has_resource || node->ResourceClass.empty())
+                    return true;
+                has_resource = resources.acquire(node->ResourceClass, [this, state, index]()
+                                                 { get_pool().post([this, state, index]()
+                                                                   { run_scheduled_node(state, index, true); }); });
+                return has_resource;
+            };
+            // 记录到执行轨迹中的结果
+            const char *status = skipped ? "跳过" : "执行";
+            // 执行已取消或超过期限，剩下的节点都不再开始
+            if (!skipped && state->token->is_cancelled())
+            {
+                auto result = ExecuteResult::ErrorNode(node->ID, state->token->reason());
+                if (state->context)
+                    state->context->set_result(node->ID, result);
+                else
+                    node->LastExecuteResult = result;
+                state->add_cancelled(node);
+                skipped = true;
+                status = "取消";
+            }
+            if (!skipped && state->context)
+            {
+                if (!acquire())
+                    return;
+                // 上下文中的值每次都是新的，不使用增量执行和结果缓存
+                current_context = state->context.get();
+                current_cancel_token = state->token.get();
+                current_plan_cursor = {state->plan.get(), index};
+                auto result = execute_planned(*state->plan, index);
+                current_plan_cursor = {};
+                current_cancel_token = nullptr;
+                current_context = nullptr;
+                state->context->set_result(node->ID, result);
+                if (result.has_error() && state->token->is_cancelled())
+                    state->add_cancelled(node);
+                skipped = result.has_error();
+                if (skipped)
+                    status = "错误";
+            }
+            else if (!skipped && state->plan->is_fused_member(index))
+            {
+                // 由链尾节点一起执行，链尾在这之后才会执行
+                if (node->Dirty)
+                    state->plan->nodes[state->plan->fused_tail[index]]->Dirty = true;
+                node->Dirty = false;
+                node->LastExecuteResult = ExecuteResult::Success();
+                status = "融合";
+            }
+            else if (!skipped)
+            {
+                // 此时上游节点都已经结束，输入的版本号不会再变化
+                auto input_versions = get_input_versions(*state->plan, index);
+                if (need_execute_node(node, input_versions))
+                {
+                    if (!acquire())
+                        return;
+                    node->Dirty = false;
+                    auto bytes_before = static_cast<int64_t>(output_image_bytes(node));
+                    current_cancel_token = state->token.get();
+                    current_plan_cursor = {state->plan.get(), index};
+                    if (!state->plan->fused_chains[index].empty())
+                    {
+                        // 融合的链不使用结果缓存，链尾节点自己的输入不能代表整条链的输入
+                        node->LastExecuteResult = execute_fused(*state->plan, index);
+                        node->update_average_time();
+                    }
+                    else if (ExecuteNode(node) && state->shared_with_cache)
+                    {
+                        state->shared_with_cache[index] = true;
+                    }
+                    state->add_resident(static_cast<int64_t>(output_image_bytes(node)) - bytes_before);
+                    current_plan_cursor = {};
+                    current_cancel_token = nullptr;
+                    node->LastInputVersions = std::move(input_versions);
+                    executed_count++;
+                    if (state->profiled)
+                        profile_node(*state, index, start);
+                    // 节点在执行中途发现取消而提前返回
+                    if (node->LastExecuteResult.has_error() && state->token->is_cancelled())
+                        state->add_cancelled(node);
+                }
+                else
+                {
+                    // 输入没有变化，沿用上次的输出
+                    reused_count++;
+                    status = "沿用";
+                }
+                skipped = node->LastExecuteResult.has_error();
+                if (skipped)
+                    status = "错误";
+            }
+            if (has_resource)
+                resources.release(node->ResourceClass);
+            if (state->traced)
+                trace_node(*state, index, start, status);
+            if (state->readers_left)
+                release_dead_outputs(*state, index);
+            // 节点运行错误时，依赖它的节点都不再运行
+            for (auto successor : state->plan->successors[index])
+            {
+                if (skipped)
+                    state->skip[successor] = true;
+                if (state->indegree[successor].fetch_sub(1) == 1)
+                    schedule_node(state, successor);
+            }
+            state->remaining--;
+        }
+
+        // 节点结束后，释放它是最后一个读者的上游输出
+        // 释放的节点标记为需要重新执行，下一次执行时重新生成输出
+        void release_dead_outputs(schedule_state &state, size_t index)
+        {
+            auto &plan = *state.plan;
+            for (auto id : plan.reads[index])
+            {
+                if (state.readers_left[id].fetch_sub(1) != 1 || plan.output_keep[id])
+                    continue;
+                size_t producer = std::upper_bound(plan.output_base.begin(), plan.output_base.end(), id) - plan.output_base.begin() - 1;
+                if (state.shared_with_cache[producer])
+                    continue;
+                auto node = plan.nodes[producer];
+                auto &output = node->Outputs[id - plan.output_base[producer]];
+                if (!std::holds_alternative<cv::Mat>(*output.Value))
+                    continue;
+                auto bytes = static_cast<int64_t>(image_bytes(std::get<cv::Mat>(*output.Value)));
+                output.Value = cv::Mat();
+                output.needUpdateTexture = true;
+                node->Dirty = true;
+                state.add_resident(-bytes);
+                state.released_bytes += bytes;
+                if (state.traced)
+                    trace.instant("释放 " + node->Name, "memory", std::chrono::steady_clock::now(), {{"bytes", bytes}});
+            }
+        }
+
+        // 在独立的上下文中执行全图，端口的值和节点的结果都写入上下文，不修改图中的端口
+        // 同一个图的多个上下文可以同时执行，执行期间不能修改图的节点和连线
+        void ExecuteContext(const std::shared_ptr<execution_context> &context)
+        {
+            auto state = std::make_shared<schedule_state>();
+            state->plan = get_plan();
+            const size_t count = state->plan->nodes.size();
+            auto &indegree = state->plan->indegree;
+            auto &order = state->plan->order;
+            state->context = context;
+            context->bind(state->plan.get(), state->plan->output_base[count]);
+            state->token = std::make_shared<cancel_token>();
+            if (order.empty())
+                return;
+
+            state->indegree = std::make_unique<std::atomic<int>[]>(count);
+            state->skip = std::make_unique<std::atomic<bool>[]>(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                state->indegree[i] = indegree[i];
+                state->skip[i] = false;
+            }
+            state->remaining = order.size();
+            begin_trace(*state);
+            auto begin = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < count; i++)
+                if (indegree[i] == 0)
+                    schedule_node(state, i);
+            get_pool().wait_until([&state]()
+                                  { return state->remaining == 0; });
+            if (state->traced)
+                trace.complete("上下文执行", "scheduler", begin, std::chrono::steady_clock::now(), {{"run", state->trace_run}});
+        }
+
+        std::future<void> async_execute_context(const std::shared_ptr<execution_context> &context)
+        {
+            return get_pool().submit([this, context]
+                                     { ExecuteContext(context); });
+        }
+
+        // 在界面上显示上下文的结果：把上下文中的值写入图中的端口
+        // 正在执行时推迟到执行结束后，由界面线程在 async_execute 中发布
+        void publish_context(const std::shared_ptr<execution_context> &context)
+        {
+            std::lock_guard<std::mutex> lock(publish_mutex);
+            pending_publish = context;
+        }
+
+        // 流式执行：源节点连续产生多帧，每个节点按帧的顺序串行执行，不同节点可以同时处理不同的帧
+        // 节点 n 处理第 f 帧需要等待：上游节点处理完第 f 帧，节点 n 处理完第 f-1 帧
+        // 源节点处理第 f 帧还需要等待第 f-max_in_flight 帧全部结束，限制同时处理的帧数
+        struct stream_frame
+        {
+            execution_context context;
+            std::unique_ptr<std::atomic<int>[]> pending;
+            std::unique_ptr<std::atomic<bool>[]> skip;
+            std::atomic<size_t> remaining = 0;
+        };
+
+        struct stream_state
+        {
+            schedule_state topology;
+            std::vector<std::unique_ptr<stream_frame>> frames;
+            size_t max_in_flight = 1;
+            // 源节点出错（例如图片列表读取失败）后，从该帧开始不再执行
+            std::atomic<size_t> stop_frame = std::numeric_limits<size_t>::max();
+            std::atomic<size_t> finished_frames = 0;
+            // 已经发布到图中端口的帧数，在 publish_mutex 中访问
+            size_t published_frames = 0;
+        };
+
+        void ExecuteStream(size_t frame_count, size_t max_in_flight)
+        {
+            auto state = std::make_shared<stream_state>();
+            state->topology.plan = get_plan();
+            state->topology.token = begin_run();
+            auto &plan = *state->topology.plan;
+            stream_frame_count = frame_count;
+            stream_finished_frames = 0;
+            if (plan.order.empty() || frame_count == 0)
+            {
+                end_run(state->topology);
+                return;
+            }
+
+            const size_t count = plan.nodes.size();
+            state->max_in_flight = std::max<size_t>(1, max_in_flight);
+            for (size_t f = 0; f < frame_count; f++)
+            {
+                auto frame = std::make_unique<stream_frame>();
+                frame->context.bind(&plan, plan.output_base[count]);
+                frame->pending = std::make_unique<std::atomic<int>[]>(count);
+                frame->skip = std::make_unique<std::atomic<bool>[]>(count);
+                for (size_t i = 0; i < count; i++)
+                {
+                    int pending = plan.indegree[i];
+                    if (f > 0)
+                        pending++;
+                    if (plan.indegree[i] == 0 && f >= state->max_in_flight)
+                        pending++;
+                    frame->pending[i] = pending;
+                    frame->skip[i] = false;
+                }
+                frame->remaining = plan.order.size();
+                state->frames.push_back(std::move(frame));
+            }
+
+            begin_trace(state->topology);
+            auto begin = std::chrono::steady_clock::now();
+            for (auto index : plan.order)
+                if (plan.indegree[index] == 0)
+                    schedule_stream_node(state, index, 0);
+
+            get_pool().wait_until([&state, frame_count]()
+                                  { return state->finished_frames == frame_count; });
+
+            auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+            size_t frames = std::min(frame_count, state->stop_frame.load());
+            stream_fps = seconds > 0 ? frames / seconds : 0.0;
+            if (state->topology.traced)
+                trace.complete("流式执行", "scheduler", begin, std::chrono::steady_clock::now(), {{"run", state->topology.trace_run}, {"frames", frames}});
+            end_run(state->topology);
+        }
+
+        void schedule_stream_node(const std::shared_ptr<stream_state> &state, size_t index, size_t frame_index)
+        {
+            get_pool().post([this, state, index, frame_index]()
+                            { run_stream_node(state, index, frame_index); });
+        }
+
+        void run_stream_node(const std::shared_ptr<stream_state> &state, size_t index, size_t frame_index, bool has_resource = false)
+        {
+            auto &frame = *state->frames[frame_index];
+            auto &plan = *state->topology.plan;
+            auto node = plan.nodes[index];
+            auto &token = *state->topology.token;
+            bool skipped = frame.skip[index] || frame_index >= state->stop_frame;
+            if (!skipped && token.is_cancelled())
+            {
+                // 取消后当前帧剩下的节点不再执行，也不再产生新的帧
+                state->topology.add_cancelled(node);
+                stop_stream_at(*state, frame_index);
+                skipped = true;
+            }
+            if (!skipped)
+            {
+                if (node->has_execute_mothod())
+                {
+                    if (!has_resource && !node->ResourceClass.empty())
+                    {
+                        has_resource = resources.acquire(node->ResourceClass, [this, state, index, frame_index]()
+                                                         { get_pool().post([this, state, index, frame_index]()
+                                                                           { run_stream_node(state, index, frame_index, true); }); });
+                        if (!has_resource)
+                            return;
+                    }
+                    auto start = std::chrono::steady_clock::now();
+                    current_context = &frame.context;
+                    current_cancel_token = &token;
+                    current_plan_cursor = {&plan, index};
+                    node->LastExecuteResult = execute_planned(plan, index);
+                    if (auto time = frame.context.get_execute_time(node->ID); time && !plan.is_fused_member(index))
+                        node->update_average_time(*time);
+                    current_plan_cursor = {};
+                    current_cancel_token = nullptr;
+                    current_context = nullptr;
+                    skipped = node->LastExecuteResult.has_error();
+                    // 流式执行的节点按帧顺序执行，不记录排队等待
+                    if (state->topology.traced)
+                        trace.complete(node->Name, "node", start, std::chrono::steady_clock::now(), {{"node_id", static_cast<uint64_t>(node->ID.Get())}, {"frame", frame_index}, {"status", skipped ? "错误" : "执行"}});
+                }
+                // 源节点（图片列表、截图等）出错时停止产生后续的帧
+                if (skipped && plan.indegree[index] == 0 && node->AlwaysExecute)
+                    stop_stream_at(*state, frame_index);
+            }
+            if (has_resource)
+                resources.release(node->ResourceClass);
+
+            for (auto successor : plan.successors[index])
+            {
+                if (skipped)
+                    frame.skip[successor] = true;
+                if (frame.pending[successor].fetch_sub(1) == 1)
+                    schedule_stream_node(state, successor, frame_index);
+            }
+            // 同一个节点的下一帧
+            if (frame_index + 1 < state->frames.size() && state->frames[frame_index + 1]->pending[index].fetch_sub(1) == 1)
+                schedule_stream_node(state, index, frame_index + 1);
+
+            if (frame.remaining.fetch_sub(1) == 1)
+                finish_stream_frame(state, frame_index);
+        }
+
+        // 从第 frame_index 帧开始不再执行
+        static void stop_stream_at(stream_state &state, size_t frame_index)
+        {
+            size_t stop = state.stop_frame;
+            while (frame_index < stop && !state.stop_frame.compare_exchange_weak(stop, frame_index))
+                ;
+        }
+
+        void finish_stream_frame(const std::shared_ptr<stream_state> &state, size_t frame_index)
+        {
+            // 界面显示最新完成的一帧，然后释放这一帧的中间结果
+            {
+                std::lock_guard<std::mutex> lock(publish_mutex);
+                if (frame_index + 1 > state->published_frames)
+                {
+                    publish_values(state->frames[frame_index]->context);
+                    state->published_frames = frame_index + 1;
+                }
+            }
+            state->frames[frame_index]->context.clear();
+            stream_finished_frames++;
+            // 放行 max_in_flight 帧之后的源节点
+            size_t next = frame_index + state->max_in_flight;
+            if (next < state->frames.size())
+            {
+                auto &plan = *state->topology.plan;
+                for (auto index : plan.order)
+                    if (plan.indegree[index] == 0 && state->frames[next]->pending[index].fetch_sub(1) == 1)
+                        schedule_stream_node(state, index, next);
+            }
+            // 最后再增加计数，等待线程看到全部结束时不会再访问状态
+            state->finished_frames++;
+        }
+
+        void async_execute_stream(size_t frame_count, size_t max_in_flight)
+        {
+            if (!try_begin_run())
+                return;
+            needRunning = false;
+            apply_worker_count();
+            future = get_pool().submit([this, frame_count, max_in_flight]
+                                       {
+                                           running_guard guard{isRunning};
+                                           ExecuteStream(frame_count, max_in_flight); });
+        }
+
+        // 流式执行的进度和吞吐
+        std::atomic<size_t> stream_frame_count = 0;
+        std::atomic<size_t> stream_finished_frames = 0;
+        std::atomic<double> stream_fps = 0;
+
+        static size_t image_bytes(const cv::Mat &image)
+        {
+            return image.total() * image.elemSize();
+        }
+
+        static size_t output_image_bytes(Node *node)
+        {
+            size_t bytes = 0;
+            for (auto &output : node->Outputs)
+                if (std::holds_alternative<cv::Mat>(*output.Value))
+                    bytes += image_bytes(std::get<cv::Mat>(*output.Value));
+            return bytes;
+        }
+
+        // 低内存执行：图像输出的所有读者结束后立即释放，被释放的节点下一次执行时重新计算
+        std::atomic<bool> low_memory = false;
+        // 上次执行中端口持有的图像字节数的峰值，以及低内存执行释放的字节数
+        std::atomic<size_t> peak_resident_bytes = 0;
+        std::atomic<size_t> released_bytes = 0;
+        // 上次执行中分配图像内存的次数，节点复用上一次的输出缓冲区时不会分配
+        std::atomic<size_t> last_run_allocations = 0;
+
+        // 每个输入的版本：有连接时取上游输出端口的版本，否则取输入端口自身的版本
+        static std::vector<std::pair<uintptr_t, uint64_t>> get_input_versions(const execution_plan &plan, size_t index)
+        {
+            std::vector<std::pair<uintptr_t, uint64_t>> versions;
+            // 融合链的链尾代表整条链，包含链上所有节点的输入
+            auto append = [&](size_t member)
+            {
+                auto node = plan.nodes[member];
+                for (size_t i = 0; i < node->Inputs.size(); i++)
+                {
+                    auto source = plan.source_pin(member, i);
+                    auto pin = source ? source : &node->Inputs[i];
+                    versions.emplace_back(pin->ID.Get(), pin->Version);
+                }
+            };
+            if (plan.fused_chains[index].empty())
+                append(index);
+            else
+                for (auto member : plan.fused_chains[index])
+                    append(member);
+            return versions;
+        }
+
+        bool need_execute_node(Node *node, const std::vector<std::pair<uintptr_t, uint64_t>> &input_versions)
+        {
+            if (!incremental || node->AlwaysExecute || node->Dirty)
+                return true;
+            // 上次执行出错的节点需要重新执行
+            if (node->LastExecuteResult.has_error())
+                return true;
+            return node->LastInputVersions != input_versions;
+        }
+
+        // 增量执行：只执行输入发生变化的节点，其余节点沿用上次的输出
+        std::atomic<bool> incremental = true;
+        // 上次执行中实际执行和沿用输出的节点数量
+        std::atomic<size_t> executed_count = 0;
+        std::atomic<size_t> reused_count = 0;
+
+        bool is_stoped()
+        {
+            return isStoped.load();
+        }
+
+        void need_stop()
+        {
+            isStoped.store(true);
+            stop_loop();
+        }
+
+        // 请求执行，按“最新请求优先”取消正在进行的执行
+        void need_execute()
+        {
+            needRunning = true;
+            if (cancel_stale_run && isRunning)
+                cancel_run();
+            async_execute();
+        }
+
+        // 只在界面线程调用，每帧调用一次以开始执行期间到达的请求
+        void async_execute()
+        {
+            apply_pending_publish();
+            // 有未处理的请求，且没有正在执行
+            if (needRunning && try_begin_run())
+            {
+                apply_worker_count();
+                future = get_pool().submit([this]
+                                           {
+                                               running_guard guard{isRunning};
+                                               // 执行期间到达的请求在结束后立即处理，请求不会丢失
+                                               do
+                                               {
+                                                   needRunning = false;
+                                                   execture_stopwatch();
+                                               } while (needRunning && !is_stoped()); });
+            }
+            if (future.valid() && future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+                future.get();
+            }
+        }
+
+        // 取消正在进行的执行
+        void cancel_run()
+        {
+            std::lock_guard<std::mutex> lock(run_mutex);
+            if (run_token)
+                run_token->cancel();
+        }
+
+        // 上次执行中因取消或超时没有执行完的节点
+        struct cancel_report
+        {
+            std::string reason;
+            std::vector<std::string> nodes;
+        };
+
+        cancel_report get_cancel_report()
+        {
+            std::lock_guard<std::mutex> lock(run_mutex);
+            return last_cancel_report;
+        }
+
+        // 固定频率循环执行，在独立的线程中产生节拍，和界面刷新解耦
+        void start_loop(double rate_hz, loop_scheduler::policy policy, size_t queue_limit)
+        {
+            loop.start(rate_hz, policy, queue_limit, {[this]()
+                                                      { return try_start_run(); },
+                                                      [this]()
+                                                      { cancel_run(); }});
+        }
+
+        void stop_loop()
+        {
+            loop.stop();
+        }
+
+        bool is_looping() const
+        {
+            return loop.is_running();
+        }
+
+        loop_scheduler::stats_t get_loop_stats()
+        {
+            return loop.get_stats();
+        }
+
+        // 最新请求优先：新的请求到来时取消正在进行的执行
+        std::atomic<bool> cancel_stale_run = true;
+        // 每次执行的期限（毫秒），超过后剩下的节点不再执行，0 表示不限制
+        std::atomic<double> deadline_ms = 0;
+
+        // 在线程池中单独执行一个节点
+        // 结果先写入独立的上下文再发布，不会和正在进行的执行同时写端口
+        std::future<void> async_execute_node(Node *node)
+        {
+            return get_pool().submit([this, node]
+                                     {
+                                         auto context = std::make_shared<execution_context>();
+                                         // 上游节点不在这个上下文中执行，先把上游输出的当前值放入上下文
+                                         for (auto &input : node->Inputs)
+                                             if (auto link = graph->FindPinLink(input.ID))
+                                                 if (auto start_pin = graph->FindPin(link->StartPinID); start_pin && start_pin->Kind == PinKind::Output)
+                                                     context->set(start_pin->ID, start_pin->Value);
+                                         current_context = context.get();
+                                         auto result = node->OnExecuteEx(graph, node);
+                                         current_context = nullptr;
+                                         context->set_result(node->ID, result);
+                                         publish_context(context); });
+        }
 
-        return nullptr;
+        // 工作线程数，0 表示使用硬件线程数
+        size_t get_worker_count()
+        {
+            if (worker_count == 0)
+                return work_stealing_pool::default_worker_count();
+            return worker_count;
+        }
+
+        // 设置工作线程数，正在执行时在下一次执行前生效
+        void set_worker_count(size_t count)
+        {
+            worker_count = count;
+            if (!isRunning)
+                apply_worker_count();
+        }
+
+        // 线程池延迟创建，反序列化时创建的临时图不会启动工作线程
+        work_stealing_pool &get_pool()
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            if (!pool)
+            {
+                pool = std::make_unique<work_stealing_pool>(worker_count);
+                // 节点里的 OpenCV 并行运算也在这个线程池上执行
+                opencv_parallel::instance().install();
+            }
+            return *pool;
+        }
+
+    private:
+        // 占用执行状态后发布，避免和正在进行的执行同时写端口
+        void apply_pending_publish()
+        {
+            {
+                std::lock_guard<std::mutex> lock(publish_mutex);
+                if (!pending_publish)
+                    return;
+            }
+            if (!try_begin_run())
+                return;
+            running_guard guard{isRunning};
+            std::lock_guard<std::mutex> lock(publish_mutex);
+            if (pending_publish)
+                publish_values(*pending_publish);
+            pending_publish.reset();
+        }
+
+        // 调用者持有 publish_mutex，且当前线程不在上下文中执行
+        void publish_values(execution_context &context)
+        {
+            std::lock_guard<std::mutex> lock(context.mutex);
+            for (auto &slot : context.slots)
+                if (slot.has_value)
+                    if (auto pin = graph->FindPin(slot.id))
+                        pin->SetPortValue(slot.value);
+            for (auto &[id, value] : context.values)
+                if (auto pin = graph->FindPin(ed::PinId(id)))
+                    pin->SetPortValue(value);
+            for (auto &[id, result] : context.results)
+                if (auto node = graph->FindNode(ed::NodeId(id)))
+                    node->LastExecuteResult = result;
+            for (auto &[id, time] : context.execute_times)
+                if (auto node = graph->FindNode(ed::NodeId(id)))
+                    node->ExecuteTime = time;
+        }
+
+        // 界面线程和循环调度线程都会开始执行，用比较交换保证同一时间只有一次执行
+        bool try_begin_run()
+        {
+            bool expected = false;
+            return isRunning.compare_exchange_strong(expected, true);
+        }
+
+        // 循环调度器的一个节拍，正在执行时返回空
+        std::optional<std::future<void>> try_start_run()
+        {
+            if (is_stoped() || !try_begin_run())
+                return std::nullopt;
+            // 这次执行同时满足界面上未处理的请求
+            needRunning = false;
+            apply_worker_count();
+            return get_pool().submit([this]
+                                     {
+                                         running_guard guard{isRunning};
+                                         execture_stopwatch(); });
+        }
+
+        std::shared_ptr<cancel_token> begin_run()
+        {
+            auto token = std::make_shared<cancel_token>();
+            if (deadline_ms > 0)
+                token->deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(deadline_ms.load()));
+            std::lock_guard<std::mutex> lock(run_mutex);
+            run_token = token;
+            return token;
+        }
+
+        void end_run(schedule_state &state)
+        {
+            cancel_report report;
+            {
+                std::lock_guard<std::mutex> lock(state.cancelled_mutex);
+                std::set<Node *> reported;
+                for (auto node : state.cancelled)
+                    if (reported.insert(node).second)
+                        report.nodes.push_back(node->Name);
+            }
+            if (!report.nodes.empty())
+                report.reason = state.token->reason();
+            std::lock_guard<std::mutex> lock(run_mutex);
+            last_cancel_report = std::move(report);
+            if (run_token == state.token)
+                run_token.reset();
+        }
+
+        void apply_worker_count()
+        {
+            std::lock_guard<std::mutex> lock(pool_mutex);
+            if (pool && pool->worker_count() != get_worker_count())
+                pool->resize(get_worker_count());
+        }
+
+        size_t worker_count = 0;
+        std::mutex pool_mutex;
+        std::mutex publish_mutex;
+        std::shared_ptr<execution_context> pending_publish;
+        // 执行计划和编译时图的拓扑，拓扑变化后重新编译
+        struct plan_key_t
+        {
+            uint64_t version = 0;
+            const Node *nodes_data = nullptr;
+            size_t nodes_size = 0;
+            const Link *links_data = nullptr;
+            size_t links_size = 0;
+            bool fuse = false;
+            bool tiled = false;
+
+            bool operator==(const plan_key_t &other) const
+            {
+                return version == other.version && nodes_data == other.nodes_data && nodes_size == other.nodes_size &&
+                       links_data == other.links_data && links_size == other.links_size && fuse == other.fuse && tiled == other.tiled;
+            }
+        };
+        std::mutex plan_mutex;
+        std::shared_ptr<const execution_plan> cached_plan;
+        plan_key_t plan_key;
+        // 正在进行的执行的取消令牌
+        std::mutex run_mutex;
+        std::shared_ptr<cancel_token> run_token;
+        cancel_report last_cancel_report;
+        // 放在其他成员之后，析构时先于它们等待工作线程结束
+        std::unique_ptr<work_stealing_pool> pool;
+        // 在线程池之后声明，先于线程池析构，停止时等待正在进行的执行结束
+        loop_scheduler loop;
+    };
+    ExectureEnv env;
+
+    // 查找索引：节点、端口、连线的 ID 到指针的映射
+    // 节点或连线变化后在下一次查找时重建
+    struct graph_index
+    {
+        bool valid = false;
+        const Node *nodes_data = nullptr;
+        size_t nodes_size = 0;
+        const Link *links_data = nullptr;
+        size_t links_size = 0;
+        std::unordered_map<uintptr_t, Node *> nodes;
+        std::unordered_map<uintptr_t, Pin *> pins;
+        std::unordered_map<uintptr_t, Link *> links;
+        // 端口的所有连线，顺序和 Links 中一致
+        std::unordered_map<uintptr_t, std::vector<Link *>> pin_links;
+    };
+
+    // 节点、端口或连线被修改后调用，使索引和执行计划失效
+    void invalidate_index()
+    {
+        std::unique_lock<std::shared_mutex> lock(index_mutex);
+        index.valid = false;
+        topology_version++;
     }
 
-    Link *FindLink(ed::LinkId id)
+    // 拓扑版本，每次调用 invalidate_index 时增加
+    uint64_t get_topology_version() const
     {
-        for (auto &link : Links)
-            if (link.ID == id)
-                return &link;
+        return topology_version;
+    }
 
-        return nullptr;
+    Node *FindNode(ed::NodeId id)
+    {
+        return with_index([id](graph_index &index) -> Node *
+                          {
+                              auto it = index.nodes.find(id.Get());
+                              return it == index.nodes.end() ? nullptr : it->second; });
+    }
+
+    Link *FindLink(ed::LinkId id)
+    {
+        return with_index([id](graph_index &index) -> Link *
+                          {
+                              auto it = index.links.find(id.Get());
+                              return it == index.links.end() ? nullptr : it->second; });
     }
 
     Pin *FindPin(ed::PinId id)
@@ -918,18 +2559,10 @@ struct Graph
         if (!id)
             return nullptr;
 
-        for (auto &node : Nodes)
-        {
-            for (auto &pin : node.Inputs)
-                if (pin.ID == id)
-                    return &pin;
-
-            for (auto &pin : node.Outputs)
-                if (pin.ID == id)
-                    return &pin;
-        }
-
-        return nullptr;
+        return with_index([id](graph_index &index) -> Pin *
+                          {
+                              auto it = index.pins.find(id.Get());
+                              return it == index.pins.end() ? nullptr : it->second; });
     }
 
     bool IsPinLinked(ed::PinId id)
@@ -937,11 +2570,8 @@ struct Graph
         if (!id)
             return false;
 
-        for (auto &link : Links)
-            if (link.StartPinID == id || link.EndPinID == id)
-                return true;
-
-        return false;
+        return with_index([id](graph_index &index)
+                          { return index.pin_links.find(id.Get()) != index.pin_links.end(); });
     }
 
     Link *FindPinLink(ed::PinId id)
@@ -949,30 +2579,123 @@ struct Graph
         if (!id)
             return nullptr;
 
-        for (auto &link : Links)
-            if (link.StartPinID == id || link.EndPinID == id)
-                return &link;
-
-        return nullptr;
+        return with_index([id](graph_index &index) -> Link *
+                          {
+                              auto it = index.pin_links.find(id.Get());
+                              return it == index.pin_links.end() ? nullptr : it->second.front(); });
     }
 
     std::vector<Link *> FindPinLinks(ed::PinId id)
     {
-        std::vector<Link *> links;
+        return with_index([id](graph_index &index)
+                          {
+                              auto it = index.pin_links.find(id.Get());
+                              return it == index.pin_links.end() ? std::vector<Link *>() : it->second; });
+    }
 
-        for (auto &link : Links)
-            if (link.StartPinID == id || link.EndPinID == id)
-                links.push_back(&link);
+    // 添加连线
+    Link *add_link(const Link &link)
+    {
+        Links.push_back(link);
+        invalidate_index();
+        return &Links.back();
+    }
 
-        return links;
+    // 删除连线
+    bool remove_link(ed::LinkId id)
+    {
+        auto it = std::find_if(Links.begin(), Links.end(), [id](auto &link)
+                               { return link.ID == id; });
+        if (it == Links.end())
+            return false;
+        Links.erase(it);
+        invalidate_index();
+        return true;
+    }
+
+    // 删除节点
+    bool remove_node(ed::NodeId id)
+    {
+        auto it = std::find_if(Nodes.begin(), Nodes.end(), [id](auto &node)
+                               { return node.ID == id; });
+        if (it == Nodes.end())
+            return false;
+        Nodes.erase(it);
+        build_nodes();
+        return true;
+    }
+
+    // 清空所有节点和连线
+    void clear()
+    {
+        Nodes.clear();
+        Links.clear();
+        invalidate_index();
     }
 
     void auto_arrange();
 
-    void gen_ast_code();
+    // 导出为独立的 C++ 程序，写入目录中的 pipeline.cpp 和 CMakeLists.txt
+    ExecuteResult gen_ast_code(const std::string &output_dir);
 
     bool serialize(std::string &json_buff);
     bool deserialize(const std::string &json_buff);
+
+private:
+    // 显式写出返回类型，在类中 with_index 的定义之前使用时 GCC 无法推导 auto
+    template <typename F>
+    auto with_index(F &&func) -> decltype(func(std::declval<graph_index &>()))
+    {
+        {
+            std::shared_lock<std::shared_mutex> lock(index_mutex);
+            if (is_index_valid())
+                return func(index);
+        }
+        std::unique_lock<std::shared_mutex> lock(index_mutex);
+        if (!is_index_valid())
+            rebuild_index();
+        return func(index);
+    }
+
+    bool is_index_valid() const
+    {
+        // 节点或连线数组重新分配、增删时，数据指针或大小会变化
+        return index.valid &&
+               index.nodes_data == Nodes.data() && index.nodes_size == Nodes.size() &&
+               index.links_data == Links.data() && index.links_size == Links.size();
+    }
+
+    void rebuild_index()
+    {
+        index.nodes.clear();
+        index.pins.clear();
+        index.links.clear();
+        index.pin_links.clear();
+        for (auto &node : Nodes)
+        {
+            index.nodes.emplace(node.ID.Get(), &node);
+            for (auto &pin : node.Inputs)
+                index.pins.emplace(pin.ID.Get(), &pin);
+            for (auto &pin : node.Outputs)
+                index.pins.emplace(pin.ID.Get(), &pin);
+        }
+        for (auto &link : Links)
+        {
+            index.links.emplace(link.ID.Get(), &link);
+            index.pin_links[link.StartPinID.Get()].push_back(&link);
+            if (link.EndPinID != link.StartPinID)
+                index.pin_links[link.EndPinID.Get()].push_back(&link);
+        }
+        index.nodes_data = Nodes.data();
+        index.nodes_size = Nodes.size();
+        index.links_data = Links.data();
+        index.links_size = Links.size();
+        index.valid = true;
+    }
+
+    graph_index index;
+    std::shared_mutex index_mutex;
+    std::atomic<uint64_t> topology_version = 0;
 };
 
 #include "factory_group.hpp"
@@ -1035,7 +2758,15 @@ inline bool Graph::deserialize(const std::string &json_buff)
                                                  [&](Node *node)
                                                  { g.build_node(node); },
                                                  g.Nodes, this->env.app);
+                    n.TypeName = tmp_node->TypeName;
                     n.OnExecute = tmp_node->OnExecute;
+                    n.OnPointwise = tmp_node->OnPointwise;
+                    n.OnLocal = tmp_node->OnLocal;
+                    n.AlwaysExecute = tmp_node->AlwaysExecute;
+                    // 保存过固定状态时使用保存的值，用户可以取消节点类型默认的固定；旧的工程文件使用节点类型的默认值
+                    if (!node.as_object().contains("node_pinned"))
+                        n.Pinned = tmp_node->Pinned;
+                    n.ResourceClass = tmp_node->ResourceClass;
                     n.state_value = tmp_node->state_value;
                     n.ast = tmp_node->ast;
                     for (auto &input : n.Inputs)
@@ -1087,42 +2818,100 @@ inline bool Graph::deserialize(const std::string &json_buff)
     return false;
 }
 
-#define try_catch_block                                        \
-    node->BeginExecuteTime = std::chrono::steady_clock::now(); \
-    try                                                        \
-    {
-
-#define catch_block_and_return                                           \
-    }                                                                    \
-    catch (const std::exception &e)                                      \
-    {                                                                    \
-        return ExecuteResult::ErrorNode(node->ID, e.what());             \
-    }                                                                    \
-    catch (...)                                                          \
-    {                                                                    \
-        return ExecuteResult::ErrorNode(node->ID, "Unknown error");      \
-    }                                                                    \
-    node->EndExecuteTime = std::chrono::steady_clock::now();             \
-    node->ExecuteTime = *node->EndExecuteTime - *node->BeginExecuteTime; \
+// 执行时间由 OnExecuteEx 统一记录，节点内部不写入，在多个上下文中同时执行时不会互相覆盖
+#define try_catch_block \
+    try                 \
+    {
+
+#define catch_block_and_return                                      \
+    }                                                               \
+    catch (const std::exception &e)                                 \
+    {                                                               \
+        return ExecuteResult::ErrorNode(node->ID, e.what());        \
+    }                                                               \
+    catch (...)                                                     \
+    {                                                               \
+        return ExecuteResult::ErrorNode(node->ID, "Unknown error"); \
+    }                                                               \
+    return ExecuteResult::Success();
+
+// 在节点内部的循环中检查，执行被取消时提前返回
+#define return_if_cancelled                                                        \
+    do                                                                             \
+    {                                                                              \
+        if (is_execute_cancelled())                                                \
+            return ExecuteResult::ErrorNode(node->ID, current_cancel_token->reason()); \
+    } while (0)
+
+// 按执行计划执行时，输入的来源已经在编译时确定，不需要查找连线和端口
+// 返回空表示输入不属于当前执行的节点，需要按 ID 查找
+template <typename T>
+static std::optional<ExecuteResult> get_planned_value(Pin &input, T &value)
+{
+    auto &cursor = current_plan_cursor;
+    if (!cursor.plan)
+        return std::nullopt;
+    auto node = cursor.plan->nodes[cursor.index];
+    // 输入是当前节点的端口时，序号由地址直接算出，不是当前节点的端口时按连线查找
+    auto &inputs = node->Inputs;
+    size_t input_index = &input - inputs.data();
+    if (&input < inputs.data() || input_index >= inputs.size() || input_index >= cursor.plan->inputs[cursor.index].size())
+        return std::nullopt;
+    auto &slot = cursor.plan->inputs[cursor.index][input_index];
+    if (slot.node == execution_plan::no_source)
+    {
+        if (current_context && current_context->get(input.ID, value))
+            return ExecuteResult::Success();
+        if (!input.GetValue(value))
+            return ExecuteResult::ErrorPin(input.ID, std::string("Not Find Pin Link or Not default value type: ") + typeid(T).name());
+        return ExecuteResult::Success();
+    }
+    auto source = cursor.plan->source_pin(cursor.index, input_index);
+    if (!source)
+        return ExecuteResult::ErrorLink(slot.link, "Not Find Link Start Pin");
+    // 上游节点在同一个上下文中执行，上下文中没有值说明上游没有输出，不能读取图中其他执行留下的值
+    if (current_context)
+    {
+        auto &base = cursor.plan->output_base;
+        if (current_context->plan == cursor.plan && slot.pin < base[slot.node + 1] - base[slot.node] && current_context->get_slot(base[slot.node] + slot.pin, value))
+            return ExecuteResult::Success();
+        if (!current_context->get(source->ID, value))
+            return ExecuteResult::ErrorLink(slot.link, "Not Get Value In Context");
+        return ExecuteResult::Success();
+    }
+    if (!source->GetValue(value))
+        return ExecuteResult::ErrorLink(slot.link, "Not Get Value");
     return ExecuteResult::Success();
+}
 
+// 端口按引用传递，读取 shared_value<T> 时只共享上游的值
 template <typename T>
-static ExecuteResult get_value(Graph *graph, Pin input, T &value)
+static ExecuteResult get_value(Graph *graph, Pin &input, T &value)
 {
+    if (auto result = get_planned_value(input, value))
+        return *result;
     auto link = graph->FindPinLink(input.ID);
     if (!link)
     {
+        // 上下文可以覆盖没有连线的输入，例如每个上下文处理不同的图片
+        if (current_context && current_context->get(input.ID, value))
+            return ExecuteResult::Success();
         if (!input.GetValue(value))
             return ExecuteResult::ErrorPin(input.ID, std::string("Not Find Pin Link or Not default value type: ") + typeid(T).name());
         return ExecuteResult::Success();
     }
+    // 在上下文中执行时只读取上下文中上游的输出
+    if (current_context)
+    {
+        if (!current_context->get(link->StartPinID, value))
+            return ExecuteResult::ErrorLink(link->ID, "Not Get Value In Context");
+        return ExecuteResult::Success();
+    }
     auto start_pin = graph->FindPin(link->StartPinID);
-    if (!start_pin && start_pin->Kind != PinKind::Output)
+    if (!start_pin || start_pin->Kind != PinKind::Output)
         return ExecuteResult::ErrorLink(link->ID, "Not Find Link Start Pin");
     if (!start_pin->GetValue(value))
         return ExecuteResult::ErrorLink(link->ID, "Not Get Value");
-    // 从连接的端口获取值并赋值给当前端口
-    input.Value = value;
     return ExecuteResult::Success();
 }
 
@@ -158,7 +158,7 @@ Node *SpawnBytesToIntNode(const std::function<int()> &GetNextId, const std::func
 
         for (int i = 0; i < 8; i++)
         {
-            node->Inputs[i].Value = bytes[i];
+            node->Inputs[i].SetValue(bytes[i]);
         }
 
         try_catch_block;
@@ -20,7 +20,7 @@ Node *Spawn_StringOperator_Length(const std::function<int()> &GetNextId, const s
 
         try_catch_block
         {
-            node->Outputs[0].Value = static_cast<int>(str.length());
+            node->Outputs[0].SetValue(static_cast<int>(str.length()));
         }
         catch_block_and_return;
     };
@@ -46,7 +46,7 @@ Node *Spawn_StringOperator_Concatenate(const std::function<int()> &GetNextId, co
 
         try_catch_block
         {
-            node->Outputs[0].Value = str1 + str2;
+            node->Outputs[0].SetValue(str1 + str2);
         }
         catch_block_and_return;
     };
@@ -85,7 +85,7 @@ Node *Spawn_StringOperator_Split(const std::function<int()> &GetNextId, const st
             if (last < str.length())
                 result.push_back(str.substr(last));
 
-            node->Outputs[0].Value = static_cast<int>(result.size());
+            node->Outputs[0].SetValue(static_cast<int>(result.size()));
             // node->Outputs[1].Value = result;
         }
         catch_block_and_return;
@@ -120,7 +120,7 @@ Node *Spawn_StringOperator_Replace(const std::function<int()> &GetNextId, const
                 str.replace(pos, find.length(), replace);
                 pos += replace.length();
             }
-            node->Outputs[0].Value = str;
+            node->Outputs[0].SetValue(str);
         }
         catch_block_and_return;
     };
@@ -146,7 +146,7 @@ Node *Spawn_StringOperator_Find(const std::function<int()> &GetNextId, const std
 
         try_catch_block
         {
-            node->Outputs[0].Value = static_cast<int>(str.find(find));
+            node->Outputs[0].SetValue(static_cast<int>(str.find(find)));
         }
         catch_block_and_return;
     };
@@ -175,7 +175,7 @@ Node *Spawn_StringOperator_Substring(const std::function<int()> &GetNextId, cons
 
         try_catch_block
         {
-            node->Outputs[0].Value = str.substr(start, length);
+            node->Outputs[0].SetValue(str.substr(start, length));
         }
         catch_block_and_return;
     };
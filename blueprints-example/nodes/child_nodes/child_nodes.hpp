@@ -5,8 +5,10 @@
 #include "blueprint/blueprint.hpp"
 #include "flow/flow_source.hpp"
 #include "maa/maa_task.hpp"
+#ifndef IMAGE_NODE_HEADLESS
 #include "win32/win32_window.hpp"
 #include "win32/win32_softinput.hpp"
+#endif
 
 #include "base/base_type.hpp"
 #include "base/base_string.hpp"
@@ -39,7 +41,9 @@
 
 #include <filesystem>
 
+#ifndef IMAGE_NODE_HEADLESS
 #include <libocr.h>
+#endif
 
 Node *Spawn_ImageViewer(const std::function<int()> &GetNextId, const std::function<void(Node *)> &BuildNode, std::vector<Node> &m_Nodes, Application *app)
 {
@@ -48,6 +52,8 @@ Node *Spawn_ImageViewer(const std::function<int()> &GetNextId, const std::functi
     node.Type = NodeType::ImageFlow;
     node.Inputs.emplace_back(GetNextId(), PinType::Image);
     node.Inputs[0].app = app;
+    // 查看器读取的图像在低内存执行时也保留
+    node.Pinned = true;
 
     node.OnExecute = [](Graph *graph, Node *node)
     {
@@ -249,7 +255,7 @@ Node *Spawn_ImageWriteRawFile(const std::function<int()> &GetNextId, const std::
     };
 
     node.ast.code = "std::ofstream file($1, std::ios::binary);"
-                    "if (!file.is_open()) return;"
+                    "if (!file.is_open()) return false;"
                     "file.write($4.c_str(), $4.size());"
                     "file.write(reinterpret_cast<char*>($0.data), $0.cols * $0.rows * $0.channels() * static_cast<int>($0.elemSize1()));";
     node.ast.add_params({"image", "path", "depth", "little_endian", "header"});
@@ -283,9 +289,9 @@ Node *Spawn_ImageOperator_ImageGetSize(const std::function<int()> &GetNextId, co
         catch_block_and_return;
     };
 
-    node.ast.code = "cv::Size $1 = $0.size();"
-                    "int $2 = $0.cols;"
-                    "int $3 = $0.rows;";
+    node.ast.code = "$1 = $0.size();"
+                    "$2 = $0.cols;"
+                    "$3 = $0.rows;";
     node.ast.add_params({"image", "size", "width", "height"});
 
     BuildNode(&node);
@@ -322,11 +328,11 @@ Node *Spawn_ImageOperator_ImageGetRect(const std::function<int()> &GetNextId, co
         catch_block_and_return;
     };
 
-    node.ast.code = "cv::Rect $1(0, 0, $0.cols, $0.rows);"
-                    "int $2 = $1.x;"
-                    "int $3 = $1.y;"
-                    "int $4 = $1.width;"
-                    "int $5 = $1.height;";
+    node.ast.code = "$1 = cv::Rect(0, 0, $0.cols, $0.rows);"
+                    "$2 = $1.x;"
+                    "$3 = $1.y;"
+                    "$4 = $1.width;"
+                    "$5 = $1.height;";
     node.ast.add_params({"image", "rect", "x", "y", "width", "height"});
 
     BuildNode(&node);
@@ -354,7 +360,7 @@ Node *Spawn_ImageOperator_ImageGetChannels(const std::function<int()> &GetNextId
         catch_block_and_return;
     };
 
-    node.ast.code = "int $1 = $0.channels();";
+    node.ast.code = "$1 = $0.channels();";
     node.ast.add_params({"image", "channels"});
 
     BuildNode(&node);
@@ -382,7 +388,7 @@ Node *Spawn_ImageOperator_ImageGetDepth(const std::function<int()> &GetNextId, c
         catch_block_and_return;
     };
 
-    node.ast.code = "int $1 = $0.depth();";
+    node.ast.code = "$1 = $0.depth();";
     node.ast.add_params({"image", "depth"});
 
     BuildNode(&node);
@@ -416,10 +422,10 @@ Node *Spawn_ImageOperator_ImageGetAllInfo(const std::function<int()> &GetNextId,
         catch_block_and_return;
     };
 
-    node.ast.code = "cv::Size $1 = $0.size();"
-                    "cv::Point $2($0.cols / 2, $0.rows / 2);"
-                    "int $3 = $0.channels();"
-                    "int $4 = $0.depth();";
+    node.ast.code = "$1 = $0.size();"
+                    "$2 = cv::Point($0.cols / 2, $0.rows / 2);"
+                    "$3 = $0.channels();"
+                    "$4 = $0.depth();";
     node.ast.add_params({"image", "size", "center", "channels", "depth"});
 
     BuildNode(&node);
@@ -452,7 +458,7 @@ Node *Spawn_ImageOperator_ImageGetRectImage(const std::function<int()> &GetNextI
         catch_block_and_return;
     };
 
-    node.ast.code = "cv::Mat $2 = $0($1);";
+    node.ast.code = "$2 = $0($1);";
     node.ast.add_params({"image", "rect", "rect_image"});
 
     BuildNode(&node);
@@ -500,7 +506,7 @@ Node *Spawn_ImageOperator_RectImageToImage(const std::function<int()> &GetNextId
         catch_block_and_return;
     };
 
-    node.ast.code = "cv::Mat $3 = $0.clone();"
+    node.ast.code = "$3 = $0.clone();"
                     "$2.copyTo($3($1));";
     node.ast.add_params({"image", "rect", "overlay", "result_image"});
 
@@ -616,14 +622,13 @@ Node *Spawn_ImageOperator_ImageChannelSplit(const std::function<int()> &GetNextI
         catch_block_and_return;
     };
 
-    node.ast.code = "std::vector<cv::Mat> $1;"
-                    "cv::Mat $2, $3, $4, $5;"
-                    "cv::split($0, $1);"
-                    "if ($1.size() > 0) $2 = $1[0];"
-                    "if ($1.size() > 1) $3 = $1[1];"
-                    "if ($1.size() > 2) $4 = $1[2];"
-                    "if ($1.size() > 3) $5 = $1[3];";
-    node.ast.add_params({"image", "channels", "channel0", "channel1", "channel2", "channel3"});
+    node.ast.code = "std::vector<cv::Mat> $5;"
+                    "cv::split($0, $5);"
+                    "$1 = $5.size() > 0 ? $5[0] : cv::Mat();"
+                    "$2 = $5.size() > 1 ? $5[1] : cv::Mat();"
+                    "$3 = $5.size() > 2 ? $5[2] : cv::Mat();"
+                    "$4 = $5.size() > 3 ? $5[3] : cv::Mat();";
+    node.ast.add_params({"image", "channel0", "channel1", "channel2", "channel3", "channels"});
 
     BuildNode(&node);
     return &node;
@@ -672,14 +677,13 @@ Node *Spawn_ImageOperator_ImageChannelMerge(const std::function<int()> &GetNextI
         catch_block_and_return;
     };
 
-    node.ast.code = "std::vector<cv::Mat> $1;"
-                    "cv::Mat $2;"
-                    "$1.push_back($3);"
-                    "$1.push_back($4);"
-                    "$1.push_back($5);"
-                    "if (!$6.empty()) $1.push_back($6);"
-                    "cv::merge($1, $2);";
-    node.ast.add_params({"_", "channels", "image", "channel0", "channel1", "channel2", "channel3"});
+    node.ast.code = "std::vector<cv::Mat> $5;"
+                    "$5.push_back($0);"
+                    "$5.push_back($1);"
+                    "$5.push_back($2);"
+                    "if (!$3.empty()) $5.push_back($3);"
+                    "cv::merge($5, $4);";
+    node.ast.add_params({"channel0", "channel1", "channel2", "channel3", "image", "channels"});
 
     BuildNode(&node);
     return &node;
@@ -719,12 +723,15 @@ Node *Spawn_ImageOperator_ImageAndMaskCopy(const std::function<int()> &GetNextId
     return &node;
 }
 
+#ifndef IMAGE_NODE_HEADLESS
 // ImageOcrText
 Node *Spawn_ImageOperator_OcrText(const std::function<int()> &GetNextId, const std::function<void(Node *)> &BuildNode, std::vector<Node> &m_Nodes, Application *app)
 {
     m_Nodes.emplace_back(GetNextId(), "OCR 文本");
     auto &node = m_Nodes.back();
     node.Type = NodeType::ImageFlow;
+    // libocr 的 ocr_image_data 不能并发调用
+    node.ResourceClass = "ocr:1";
     node.Inputs.emplace_back(GetNextId(), PinType::Image);
     node.Outputs.emplace_back(GetNextId(), PinType::String);
 
@@ -757,21 +764,22 @@ Node *Spawn_ImageOperator_OcrText(const std::function<int()> &GetNextId, const s
         catch_block_and_return;
     };
 
-    node.ast.code = "cv::Mat $1 = $0;"
-                    "if ($0.channels() == 1) cv::cvtColor($0, $1, cv::COLOR_GRAY2BGR);"
-                    "if ($1.channels() == 4) cv::cvtColor($1, $1, cv::COLOR_BGRA2BGR);"
-                    "auto $2 = $1.data;"
-                    "auto $3 = $1.channels() * $1.cols * $1.rows;"
-                    "char $4[1024] = {0};"
-                    "auto $5 = ocr_image_data($1.cols, $1.rows, (const char*)$2, $3, $4, 1024);"
-                    "if ($5 != 0) return;"
-                    "std::string $6 = std::string($4);";
-    node.ast.add_params({"image", "roi", "data", "data_size", "result", "error_code", "text"});
+    node.ast.code = "cv::Mat $2 = $0;"
+                    "if ($0.channels() == 1) cv::cvtColor($0, $2, cv::COLOR_GRAY2BGR);"
+                    "if ($2.channels() == 4) cv::cvtColor($2, $2, cv::COLOR_BGRA2BGR);"
+                    "auto $3 = $2.data;"
+                    "auto $4 = $2.channels() * $2.cols * $2.rows;"
+                    "char $5[1024] = {0};"
+                    "auto $6 = ocr_image_data($2.cols, $2.rows, (const char*)$3, $4, $5, 1024);"
+                    "if ($6 != 0) return false;"
+                    "$1 = std::string($5);";
+    node.ast.add_params({"image", "text", "roi", "data", "data_size", "result", "error_code"});
     node.ast.global_define = "#include <libocr.h>";
 
     BuildNode(&node);
     return &node;
 }
+#endif
 
 // image HConcat
 Node *Spawn_ImageOperator_HConcatenateImages(const std::function<int()> &GetNextId, const std::function<void(Node *)> &BuildNode, std::vector<Node> &m_Nodes, Application *app)
@@ -800,8 +808,7 @@ Node *Spawn_ImageOperator_HConcatenateImages(const std::function<int()> &GetNext
         catch_block_and_return;
     };
 
-    node.ast.code = "cv::Mat $2;"
-                    "cv::hconcat($0, $1, $2);";
+    node.ast.code = "cv::hconcat($0, $1, $2);";
     node.ast.add_params({"left_image", "right_image", "result"});
 
     BuildNode(&node);
@@ -835,8 +842,7 @@ Node *Spawn_ImageOperator_VConcatenateImages(const std::function<int()> &GetNext
         catch_block_and_return;
     };
 
-    node.ast.code = "cv::Mat $2;"
-                    "cv::vconcat($0, $1, $2);";
+    node.ast.code = "cv::vconcat($0, $1, $2);";
     node.ast.add_params({"top_image", "bottom_image", "result"});
 
     BuildNode(&node);
@@ -860,18 +866,23 @@ Node *Spawn_ImageOperator_GridSplitImages(const std::function<int()> &GetNextId,
 
     node.OnExecute = [](Graph *graph, Node *node)
     {
+        // 返回 false 表示执行已被取消
         static auto SplitImage = [](cv::Mat &image, int rows, int cols, std::vector<cv::Mat> &images)
         {
             int rowsize = image.rows / rows;
             int colsize = image.cols / cols;
             for (int i = 0; i < rows; i++)
             {
+                // 每一行分块之间检查是否取消
+                if (is_execute_cancelled())
+                    return false;
                 for (int j = 0; j < cols; j++)
                 {
                     cv::Mat roi = image(cv::Rect(j * colsize, i * rowsize, colsize, rowsize));
                     images.push_back(roi.clone());
                 }
             }
+            return true;
         };
 
         cv::Mat image;
@@ -890,6 +901,7 @@ Node *Spawn_ImageOperator_GridSplitImages(const std::function<int()> &GetNextId,
             if (rows * cols < node->Outputs.size())
             {
                 node->Outputs.erase(node->Outputs.begin() + rows * cols, node->Outputs.end());
+                graph->invalidate_index();
             }
             if (rows * cols > node->Outputs.size())
             {
@@ -906,10 +918,12 @@ Node *Spawn_ImageOperator_GridSplitImages(const std::function<int()> &GetNextId,
                         node->Outputs[node->Outputs.size() - 1].app = graph->env.app;
                     }
                 }
+                graph->invalidate_index();
             }
 
             std::vector<cv::Mat> images;
-            SplitImage(image, rows, cols, images);
+            if (!SplitImage(image, rows, cols, images))
+                return ExecuteResult::ErrorNode(node->ID, current_cancel_token->reason());
             for (size_t i = 0; i < images.size(); i++)
             {
                 node->Outputs[i].SetValue(images[i]);
@@ -930,7 +944,9 @@ static NodeWorldGlobal::FactoryGroupFunc_t ImageBaseNodes = {{"图像查看器",
                                                              {"获取图像深度", Spawn_ImageOperator_ImageGetDepth},
                                                              {"获取图像信息", Spawn_ImageOperator_ImageGetAllInfo},};
 static NodeWorldGlobal::FactoryGroupFunc_t ImageOperationNodes = {
+#ifndef IMAGE_NODE_HEADLESS
     {"OCR 文本", Spawn_ImageOperator_OcrText},
+#endif
     {"Mask Image", Spawn_ImageOperator_MaskImage},
     {"图像通道拆分", Spawn_ImageOperator_ImageChannelSplit},
     {"图像通道合并", Spawn_ImageOperator_ImageChannelMerge},
@@ -955,7 +971,9 @@ static std::vector<std::pair<std::string, factory_func_t>> ImageBaseNodesFactory
 };
 
 static std::vector<std::pair<std::string, factory_func_t>> ImageOperationNodesFactorys = {
+#ifndef IMAGE_NODE_HEADLESS
     {"图像/操作/OCR 文本", Spawn_ImageOperator_OcrText},
+#endif
     {"图像/操作/Mask Image", Spawn_ImageOperator_MaskImage},
     {"图像/操作/图像通道拆分", Spawn_ImageOperator_ImageChannelSplit},
     {"图像/操作/图像通道合并", Spawn_ImageOperator_ImageChannelMerge},
@@ -7,6 +7,7 @@
     if (input_count < node->Inputs.size() - count_begin_number)                                          \
     {                                                                                                    \
         node->Inputs.erase(node->Inputs.begin() + input_count + count_begin_number, node->Inputs.end()); \
+        graph->invalidate_index();                                                                       \
     }                                                                                                    \
     if (input_count > node->Inputs.size())                                                               \
     {                                                                                                    \
@@ -19,6 +20,7 @@
             node->Inputs[node->Inputs.size() - 1].app = graph->env.app;                                  \
             node->Inputs[node->Inputs.size() - 1].Kind = PinKind::Input;                                 \
         }                                                                                                \
+        graph->invalidate_index();                                                                       \
     }
 
 #define auto_resize_outputs(output_count, output_name, count_begin_number)                                   \
@@ -27,6 +29,7 @@
     if (output_count < node->Outputs.size() - count_begin_number)                                            \
     {                                                                                                        \
         node->Outputs.erase(node->Outputs.begin() + output_count + count_begin_number, node->Outputs.end()); \
+        graph->invalidate_index();                                                                           \
     }                                                                                                        \
     if (output_count > node->Outputs.size())                                                                 \
     {                                                                                                        \
@@ -39,6 +42,7 @@
             node->Outputs[node->Outputs.size() - 1].app = graph->env.app;                                    \
             node->Outputs[node->Outputs.size() - 1].Kind = PinKind::Output;                                  \
         }                                                                                                    \
+        graph->invalidate_index();                                                                           \
     }
 #define break_flow_pin() value_index++
 #define auto_get_value(type, vairant_name) \
@@ -51,6 +55,7 @@ Node *Spawn_Flow_Startup(const std::function<int()> &GetNextId, const std::funct
     m_Nodes.emplace_back(GetNextId(), "控制流入口");
     auto &node = m_Nodes.back();
     node.Type = NodeType::FlowSource;
+    node.AlwaysExecute = true;
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::Int, "并行任务", 1));
     node.Outputs.push_back(Pin(GetNextId(), PinType::Flow, "任务 1"));
@@ -77,6 +82,7 @@ Node *Spawn_Flow_Shutdown(const std::function<int()> &GetNextId, const std::func
     m_Nodes.emplace_back(GetNextId(), "控制流屏障");
     auto &node = m_Nodes.back();
     node.Type = NodeType::FlowSource;
+    node.AlwaysExecute = true;
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::Int, "屏障数量", 1));
     node.Inputs.push_back(Pin(GetNextId(), PinType::Int, "并行任务", 1));
@@ -108,6 +114,7 @@ Node *Spawn_Flow_If(const std::function<int()> &GetNextId, const std::function<v
     m_Nodes.emplace_back(GetNextId(), "控制流 条件分支");
     auto &node = m_Nodes.back();
     node.Type = NodeType::FlowSource;
+    node.AlwaysExecute = true;
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::Flow));
     node.Inputs.push_back(Pin(GetNextId(), PinType::Bool, "条件", true));
@@ -136,6 +143,7 @@ Node *Spawn_Flow_While(const std::function<int()> &GetNextId, const std::functio
     m_Nodes.emplace_back(GetNextId(), "控制流 条件循环");
     auto &node = m_Nodes.back();
     node.Type = NodeType::FlowSource;
+    node.AlwaysExecute = true;
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::Flow));
     node.Inputs.push_back(Pin(GetNextId(), PinType::Bool, "条件", false));
@@ -164,6 +172,7 @@ Node *Spawn_Flow_ForEach(const std::function<int()> &GetNextId, const std::funct
     m_Nodes.emplace_back(GetNextId(), "控制流 遍历循环");
     auto &node = m_Nodes.back();
     node.Type = NodeType::FlowSource;
+    node.AlwaysExecute = true;
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::Flow));
     node.Inputs.push_back(Pin(GetNextId(), PinType::Array, "数组"));
@@ -194,6 +203,7 @@ Node *Spawn_Flow_ForEachBreak(const std::function<int()> &GetNextId, const std::
     m_Nodes.emplace_back(GetNextId(), "控制流 遍历循环(带中断)");
     auto &node = m_Nodes.back();
     node.Type = NodeType::FlowSource;
+    node.AlwaysExecute = true;
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::Flow));
     node.Inputs.push_back(Pin(GetNextId(), PinType::Array, "数组"));
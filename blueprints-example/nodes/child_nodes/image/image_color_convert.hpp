@@ -57,7 +57,7 @@ Node *Spawn_ImageNormalize(const std::function<int()> &GetNextId, const std::fun
             return ExecuteResult::ErrorNode(node->ID, "不支持的位宽");
         }
 
-        cv::Mat result;
+        cv::Mat result = node->Outputs[0].take_image_buffer();
         cv::normalize(image, result, min_value, max_value, type, depth);
 
         node->Outputs[0].SetValue(result);
@@ -121,7 +121,7 @@ Node *Spawn_ImageConvertToType(const std::function<int()> &GetNextId, const std:
             return ExecuteResult::ErrorNode(node->ID, "不支持的位宽");
         }
 
-        cv::Mat result;
+        cv::Mat result = node->Outputs[0].take_image_buffer();
         image.convertTo(result, depth, multiplier, adder);
 
         node->Outputs[0].SetValue(result);
@@ -162,7 +162,7 @@ Node *Spawn_ImageConvertScaleAbs(const std::function<int()> &GetNextId, const st
         if (image.empty())
             return ExecuteResult::ErrorNode(node->ID, "图像为空");
 
-        cv::Mat result;
+        cv::Mat result = node->Outputs[0].take_image_buffer();
         cv::convertScaleAbs(image, result, scale, offset);
 
         node->Outputs[0].SetValue(result);
@@ -170,6 +170,17 @@ Node *Spawn_ImageConvertScaleAbs(const std::function<int()> &GetNextId, const st
         catch_block_and_return;
     };
 
+    node.OnPointwise = [](Graph *graph, Node *node) -> std::optional<pointwise_op>
+    {
+        float scale = 1.0f;
+        get_value(graph, node->Inputs[1], scale);
+
+        float offset = 0.0f;
+        get_value(graph, node->Inputs[2], offset);
+
+        return pointwise_op::scale_abs(scale, offset);
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -195,7 +206,7 @@ Node *Spawn_ImageConvertToFp16(const std::function<int()> &GetNextId, const std:
         if (image.empty())
             return ExecuteResult::ErrorNode(node->ID, "图像为空");
 
-        cv::Mat result;
+        cv::Mat result = node->Outputs[0].take_image_buffer();
         cv::convertFp16(image, result);
 
         node->Outputs[0].SetValue(result);
@@ -256,7 +267,7 @@ Node *Spawn_ImageOperator_RgbaToRgb(const std::function<int()> &GetNextId, const
 
         try_catch_block
         {
-            cv::Mat rgb;
+            cv::Mat rgb = node->Outputs[0].take_image_buffer();
             cv::cvtColor(image, rgb, cv::COLOR_RGBA2RGB);
             node->Outputs[0].SetValue(rgb);
         }
@@ -369,7 +380,7 @@ Node *Spawn_ImageOperator_RGBToHSV(const std::function<int()> &GetNextId, const
         get_value(graph, node->Inputs[0], rgb);
 
         try_catch_block;
-        cv::Mat hsv;
+        cv::Mat hsv = node->Outputs[0].take_image_buffer();
         cv::cvtColor(rgb, hsv, cv::COLOR_RGB2HSV);
         node->Outputs[0].SetValue(hsv);
         catch_block_and_return;
@@ -395,7 +406,7 @@ Node *Spawn_ImageOperator_HSVToRGB(const std::function<int()> &GetNextId, const
         get_value(graph, node->Inputs[0], hsv);
 
         try_catch_block;
-        cv::Mat rgb;
+        cv::Mat rgb = node->Outputs[0].take_image_buffer();
         cv::cvtColor(hsv, rgb, cv::COLOR_HSV2RGB);
         node->Outputs[0].SetValue(rgb);
         catch_block_and_return;
@@ -421,7 +432,7 @@ Node *Spawn_ImageOperator_RGBToLAB(const std::function<int()> &GetNextId, const
         get_value(graph, node->Inputs[0], rgb);
 
         try_catch_block;
-        cv::Mat lab;
+        cv::Mat lab = node->Outputs[0].take_image_buffer();
         cv::cvtColor(rgb, lab, cv::COLOR_RGB2Lab);
         node->Outputs[0].SetValue(lab);
         catch_block_and_return;
@@ -447,7 +458,7 @@ Node *Spawn_ImageOperator_LABToRGB(const std::function<int()> &GetNextId, const
         get_value(graph, node->Inputs[0], lab);
 
         try_catch_block;
-        cv::Mat rgb;
+        cv::Mat rgb = node->Outputs[0].take_image_buffer();
         cv::cvtColor(lab, rgb, cv::COLOR_Lab2RGB);
         node->Outputs[0].SetValue(rgb);
         catch_block_and_return;
@@ -473,7 +484,7 @@ Node *Spawn_ImageOperator_RGBToYUV(const std::function<int()> &GetNextId, const
         get_value(graph, node->Inputs[0], rgb);
 
         try_catch_block;
-        cv::Mat yuv;
+        cv::Mat yuv = node->Outputs[0].take_image_buffer();
         cv::cvtColor(rgb, yuv, cv::COLOR_RGB2YUV);
         node->Outputs[0].SetValue(yuv);
         catch_block_and_return;
@@ -499,7 +510,7 @@ Node *Spawn_ImageOperator_YUVToRGB(const std::function<int()> &GetNextId, const
         get_value(graph, node->Inputs[0], yuv);
 
         try_catch_block;
-        cv::Mat rgb;
+        cv::Mat rgb = node->Outputs[0].take_image_buffer();
         cv::cvtColor(yuv, rgb, cv::COLOR_YUV2RGB);
         node->Outputs[0].SetValue(rgb);
         catch_block_and_return;
@@ -525,7 +536,7 @@ Node *Spawn_ImageOperator_RGBToYCrCb(const std::function<int()> &GetNextId, cons
         get_value(graph, node->Inputs[0], rgb);
 
         try_catch_block;
-        cv::Mat ycrcb;
+        cv::Mat ycrcb = node->Outputs[0].take_image_buffer();
         cv::cvtColor(rgb, ycrcb, cv::COLOR_RGB2YCrCb);
         node->Outputs[0].SetValue(ycrcb);
         catch_block_and_return;
@@ -551,7 +562,7 @@ Node *Spawn_ImageOperator_YCrCbToRGB(const std::function<int()> &GetNextId, cons
         get_value(graph, node->Inputs[0], ycrcb);
 
         try_catch_block;
-        cv::Mat rgb;
+        cv::Mat rgb = node->Outputs[0].take_image_buffer();
         cv::cvtColor(ycrcb, rgb, cv::COLOR_YCrCb2RGB);
         node->Outputs[0].SetValue(rgb);
         catch_block_and_return;
@@ -10,6 +10,8 @@ Node *Spawn_ImageFeature_GenerateSIFTFeature(const std::function<int()> &GetNext
     m_Nodes.emplace_back(GetNextId(), "SIFT特征点提取");
     auto &node = m_Nodes.back();
     node.Type = NodeType::ImageOperation_Feature;
+    // 同时执行太多会占满内存带宽，和非局部均值滤波共用名额
+    node.ResourceClass = "heavy-filter:4";
     node.Inputs.emplace_back(GetNextId(), "图像", PinType::Image);
     // int nfeatures = 0, int nOctaveLayers = 3,
     //     double contrastThreshold = 0.04, double edgeThreshold = 10,
@@ -51,10 +53,10 @@ Node *Spawn_ImageFeature_GenerateSIFTFeature(const std::function<int()> &GetNext
             detector->detectAndCompute(image, cv::noArray(), keypoints, descriptors);
 
             Feature output;
-            output.first = keypoints;
+            output.first = std::move(keypoints);
             output.second = descriptors;
 
-            node->Outputs[0].SetValue(output);
+            node->Outputs[0].SetValue(std::move(output));
         }
         catch_block_and_return;
     };
@@ -106,10 +108,10 @@ Node *Spawn_ImageFeature_GenerateSURFFeature(const std::function<int()> &GetNext
             detector->detectAndCompute(image, cv::noArray(), keypoints, descriptors);
 
             Feature output;
-            output.first = keypoints;
+            output.first = std::move(keypoints);
             output.second = descriptors;
 
-            node->Outputs[0].SetValue(output);
+            node->Outputs[0].SetValue(std::move(output));
         }
         catch_block_and_return;
     };
@@ -181,10 +183,10 @@ Node *Spawn_ImageFeature_GenerateORBFeature(const std::function<int()> &GetNextI
             detector->detectAndCompute(image, cv::noArray(), keypoints, descriptors);
 
             Feature output;
-            output.first = keypoints;
+            output.first = std::move(keypoints);
             output.second = descriptors;
 
-            node->Outputs[0].SetValue(output);
+            node->Outputs[0].SetValue(std::move(output));
         }
         catch_block_and_return;
     };
@@ -211,7 +213,7 @@ Node *Spawn_ImageFeature_DrawFeaturePoints(const std::function<int()> &GetNextId
         cv::Mat image;
         get_value(graph, node->Inputs[0], image);
 
-        Feature feature;
+        shared_value<Feature> feature;
         get_value(graph, node->Inputs[1], feature);
 
         cv::Scalar color;
@@ -223,7 +225,7 @@ Node *Spawn_ImageFeature_DrawFeaturePoints(const std::function<int()> &GetNextId
         try_catch_block
         {
             cv::Mat result = image.clone();
-            cv::drawKeypoints(image, feature.first, result, color, cv::DrawMatchesFlags::DRAW_RICH_KEYPOINTS);
+            cv::drawKeypoints(image, feature->first, result, color, cv::DrawMatchesFlags::DRAW_RICH_KEYPOINTS);
 
             node->Outputs[0].SetValue(result);
         }
@@ -248,7 +250,7 @@ Node *Spawn_ImageFeature_MatchFeaturePoints(const std::function<int()> &GetNextI
 
     node.OnExecute = [](Graph *graph, Node *node) -> ExecuteResult
     {
-        Feature feature1, feature2;
+        shared_value<Feature> feature1, feature2;
         get_value(graph, node->Inputs[0], feature1);
 
         get_value(graph, node->Inputs[1], feature2);
@@ -261,7 +263,8 @@ Node *Spawn_ImageFeature_MatchFeaturePoints(const std::function<int()> &GetNextI
             std::vector<std::vector<cv::DMatch>> matches;
             auto matcher = cv::DescriptorMatcher::create(cv::DescriptorMatcher::FLANNBASED);
             // matcher->knnMatch(query_fts.descriptors, train_fts.descriptors, match_group, 2);
-            matcher->knnMatch(feature1.second, feature2.second, matches, 2);
+            matcher->knnMatch(feature1->second, feature2->second, matches, 2);
+            return_if_cancelled;
 
             std::vector<cv::DMatch> good_matches;
             for (size_t i = 0; i < matches.size(); i++)
@@ -272,7 +275,7 @@ Node *Spawn_ImageFeature_MatchFeaturePoints(const std::function<int()> &GetNextI
                 }
             }
 
-            node->Outputs[0].SetValue(good_matches);
+            node->Outputs[0].SetValue(std::move(good_matches));
         }
         catch_block_and_return;
     };
@@ -303,18 +306,18 @@ Node *Spawn_ImageFeature_DrawMatchedFeaturePoints(const std::function<int()> &Ge
 
         get_value(graph, node->Inputs[1], image2);
 
-        Feature feature1, feature2;
+        shared_value<Feature> feature1, feature2;
         get_value(graph, node->Inputs[2], feature1);
 
         get_value(graph, node->Inputs[3], feature2);
 
-        std::vector<cv::DMatch> matches;
+        shared_value<Matches> matches;
         get_value(graph, node->Inputs[4], matches);
 
         try_catch_block
         {
             cv::Mat result;
-            cv::drawMatches(image1, feature1.first, image2, feature2.first, matches, result);
+            cv::drawMatches(image1, feature1->first, image2, feature2->first, *matches, result);
 
             node->Outputs[0].SetValue(result);
         }
@@ -34,7 +34,7 @@ Node *Spawn_ImageOperator_LowPassFilter(const std::function<int()> &GetNextId, c
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::Mat kernel = cv::Mat::ones(kernel_size, kernel_size, CV_32F) / (float)(kernel_size * kernel_size);
             cv::filter2D(image, result, -1, kernel, cv::Point(-1, -1), 0, border_type);
             node->Outputs[0].SetValue(result);
@@ -76,7 +76,7 @@ Node *Spawn_ImageOperator_HighPassFilter(const std::function<int()> &GetNextId,
         try_catch_block
         {
             cv::Mat kernel = cv::Mat::ones(kernel_size, kernel_size, CV_32F) / (float)(kernel_size * kernel_size);
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::filter2D(image, result, -1, kernel, cv::Point(-1, -1), 0, border_type);
             cv::subtract(image, result, result);
             node->Outputs[0].SetValue(result);
@@ -113,13 +113,27 @@ Node *Spawn_ImageOperator_BoxFilter(const std::function<int()> &GetNextId, const
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::boxFilter(image, result, -1, cv::Size(kernel_size, kernel_size), cv::Point(-1, -1), true, border_type);
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnLocal = [](Graph *graph, Node *node, int input_type) -> std::optional<local_op>
+    {
+        int kernel_size = 3;
+        get_value(graph, node->Inputs[1], kernel_size);
+
+        int border_type = cv::BORDER_DEFAULT;
+        get_value(graph, node->Inputs[2], border_type);
+
+        if (kernel_size <= 0)
+            return std::nullopt;
+        return local_op::square(kernel_size / 2, border_type, [=](const cv::Mat &src, cv::Mat &dst)
+                                { cv::boxFilter(src, dst, -1, cv::Size(kernel_size, kernel_size), cv::Point(-1, -1), true, border_type); });
+    };
+
     BuildNode(&node);
     return &node;
 }
@@ -149,13 +163,27 @@ Node *Spawn_ImageOperator_BlurFilter(const std::function<int()> &GetNextId, cons
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::blur(image, result, cv::Size(kernel_size, kernel_size), cv::Point(-1, -1), border_type);
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnLocal = [](Graph *graph, Node *node, int input_type) -> std::optional<local_op>
+    {
+        int kernel_size = 3;
+        get_value(graph, node->Inputs[1], kernel_size);
+
+        int border_type = cv::BORDER_DEFAULT;
+        get_value(graph, node->Inputs[2], border_type);
+
+        if (kernel_size <= 0)
+            return std::nullopt;
+        return local_op::square(kernel_size / 2, border_type, [=](const cv::Mat &src, cv::Mat &dst)
+                                { cv::blur(src, dst, cv::Size(kernel_size, kernel_size), cv::Point(-1, -1), border_type); });
+    };
+
     BuildNode(&node);
     return &node;
 }
@@ -189,13 +217,34 @@ Node *Spawn_ImageOperator_GaussianFilter(const std::function<int()> &GetNextId,
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::GaussianBlur(image, result, cv::Size(kernel_size, kernel_size), sigma, sigma, border_type);
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnLocal = [](Graph *graph, Node *node, int input_type) -> std::optional<local_op>
+    {
+        int kernel_size = 3;
+        get_value(graph, node->Inputs[1], kernel_size);
+
+        float sigma = 0.0;
+        get_value(graph, node->Inputs[2], sigma);
+
+        int border_type = cv::BORDER_DEFAULT;
+        get_value(graph, node->Inputs[3], border_type);
+
+        // 卷积核大小为 0 时由标准差和图像深度决定，这里不知道半径
+        if (kernel_size <= 0 || kernel_size % 2 == 0)
+            return std::nullopt;
+        return local_op::square(kernel_size / 2, border_type, [=](const cv::Mat &src, cv::Mat &dst)
+                                { cv::GaussianBlur(src, dst, cv::Size(kernel_size, kernel_size), sigma, sigma, border_type); });
+    };
+
+    node.ast.code = "cv::GaussianBlur($0, $4, cv::Size($1, $1), $2, $2, $3);";
+    node.ast.add_params({"image", "kernel_size", "sigma", "border_type", "result"});
+
     BuildNode(&node);
     return &node;
 }
@@ -221,13 +270,31 @@ Node *Spawn_ImageOperator_MedianFilter(const std::function<int()> &GetNextId, co
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::medianBlur(image, result, kernel_size);
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnLocal = [](Graph *graph, Node *node, int input_type) -> std::optional<local_op>
+    {
+        int kernel_size = 3;
+        get_value(graph, node->Inputs[1], kernel_size);
+
+        if (kernel_size <= 1 || kernel_size % 2 == 0)
+            return std::nullopt;
+        // 大于 5 的核只支持 8 位图像，不支持的类型逐个执行，由节点自己报告错误
+        if (kernel_size > 5 && CV_MAT_DEPTH(input_type) != CV_8U)
+            return std::nullopt;
+        // medianBlur 在边界外复制边缘像素
+        return local_op::square(kernel_size / 2, cv::BORDER_REPLICATE, [=](const cv::Mat &src, cv::Mat &dst)
+                                { cv::medianBlur(src, dst, kernel_size); });
+    };
+
+    node.ast.code = "cv::medianBlur($0, $2, $1);";
+    node.ast.add_params({"image", "kernel_size", "result"});
+
     BuildNode(&node);
     return &node;
 }
@@ -265,13 +332,37 @@ Node *Spawn_ImageOperator_BilateralFilter(const std::function<int()> &GetNextId,
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::bilateralFilter(image, result, kernel_size, sigma_color, sigma_space, border_type);
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnLocal = [](Graph *graph, Node *node, int input_type) -> std::optional<local_op>
+    {
+        int kernel_size = 3;
+        get_value(graph, node->Inputs[1], kernel_size);
+
+        float sigma_color = 0.0;
+        get_value(graph, node->Inputs[2], sigma_color);
+
+        float sigma_space = 0.0;
+        get_value(graph, node->Inputs[3], sigma_space);
+
+        int border_type = cv::BORDER_DEFAULT;
+        get_value(graph, node->Inputs[4], border_type);
+
+        // 浮点图像的 bilateralFilter 按整幅图像的取值范围建查找表，分块后每块的范围不同，结果和整幅图像不一致
+        if (CV_MAT_DEPTH(input_type) != CV_8U)
+            return std::nullopt;
+
+        // 和 bilateralFilter 计算邻域半径的方法一致
+        int radius = kernel_size > 0 ? kernel_size / 2 : cvRound((sigma_space <= 0 ? 1 : sigma_space) * 1.5);
+        return local_op::square(std::max(radius, 1), border_type, [=](const cv::Mat &src, cv::Mat &dst)
+                                { cv::bilateralFilter(src, dst, kernel_size, sigma_color, sigma_space, border_type); });
+    };
+
     BuildNode(&node);
     return &node;
 }
@@ -282,6 +373,8 @@ Node *Spawn_ImageOperator_NonLocalMeansFilter(const std::function<int()> &GetNex
     m_Nodes.emplace_back(GetNextId(), "非局部均值滤波");
     auto &node = m_Nodes.back();
     node.Type = NodeType::ImageOperation_Filter;
+    // 同时执行太多会占满内存带宽
+    node.ResourceClass = "heavy-filter:4";
     node.Inputs.emplace_back(GetNextId(), "图像", PinType::Image);
     /*float h = 3, float hColor = 3,
         int templateWindowSize = 7, int searchWindowSize = 21*/
@@ -308,7 +401,7 @@ Node *Spawn_ImageOperator_NonLocalMeansFilter(const std::function<int()> &GetNex
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::fastNlMeansDenoisingColored(image, result, h, hColor, templateWindowSize, searchWindowSize);
             node->Outputs[0].SetValue(result);
         }
@@ -381,12 +474,12 @@ Node *Spawn_ImageOperator_AdaptiveMeanFilter(const std::function<int()> &GetNext
         int transformType = cv::xphoto::HAAR;
         get_value(graph, node->Inputs[11], transformType);
 
-        node->Inputs[10].Value = step;
-        node->Inputs[11].Value = transformType;
+        node->Inputs[10].SetValue(step);
+        node->Inputs[11].SetValue(transformType);
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::xphoto::bm3dDenoising(image, result, h, templateWindowSize, searchWindowSize, blockMatchingStep1, blockMatchingStep2, groupSize, slidingStep, beta, normType, step, transformType);
             node->Outputs[0].SetValue(result);
         }
@@ -752,13 +752,20 @@ Node *Spawn_ImageOperator_ImageAddInt(const std::function<int()> &GetNextId, con
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             result = image + cv::Scalar(value, value, value, value);
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnPointwise = [](Graph *graph, Node *node) -> std::optional<pointwise_op>
+    {
+        int value = 0;
+        get_value(graph, node->Inputs[1], value);
+        return pointwise_op::add(static_cast<float>(value));
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -783,13 +790,20 @@ Node *Spawn_ImageOperator_ImageSubInt(const std::function<int()> &GetNextId, con
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             result = image - cv::Scalar(value, value, value, value);
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnPointwise = [](Graph *graph, Node *node) -> std::optional<pointwise_op>
+    {
+        int value = 0;
+        get_value(graph, node->Inputs[1], value);
+        return pointwise_op::add(static_cast<float>(-value));
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -814,13 +828,20 @@ Node *Spawn_ImageOperator_ImageMulInt(const std::function<int()> &GetNextId, con
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             result = image * value;
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnPointwise = [](Graph *graph, Node *node) -> std::optional<pointwise_op>
+    {
+        int value = 1;
+        get_value(graph, node->Inputs[1], value);
+        return pointwise_op::scale(static_cast<float>(value));
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -845,13 +866,23 @@ Node *Spawn_ImageOperator_ImageDivInt(const std::function<int()> &GetNextId, con
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             result = image / value;
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnPointwise = [](Graph *graph, Node *node) -> std::optional<pointwise_op>
+    {
+        int value = 1;
+        get_value(graph, node->Inputs[1], value);
+        // 除以 0 的结果交给节点自己处理
+        if (value == 0)
+            return std::nullopt;
+        return pointwise_op::scale(static_cast<float>(1.0 / value));
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -876,13 +907,20 @@ Node *Spawn_ImageOperator_ImageAddFloat(const std::function<int()> &GetNextId, c
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             result = image + cv::Scalar(value, value, value, value);
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnPointwise = [](Graph *graph, Node *node) -> std::optional<pointwise_op>
+    {
+        float value = 0.0f;
+        get_value(graph, node->Inputs[1], value);
+        return pointwise_op::add(value);
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -907,13 +945,20 @@ Node *Spawn_ImageOperator_ImageSubFloat(const std::function<int()> &GetNextId, c
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             result = image - cv::Scalar(value, value, value, value);
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnPointwise = [](Graph *graph, Node *node) -> std::optional<pointwise_op>
+    {
+        float value = 0.0f;
+        get_value(graph, node->Inputs[1], value);
+        return pointwise_op::add(-value);
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -938,13 +983,20 @@ Node *Spawn_ImageOperator_ImageMulFloat(const std::function<int()> &GetNextId, c
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             result = image * value;
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnPointwise = [](Graph *graph, Node *node) -> std::optional<pointwise_op>
+    {
+        float value = 1.0f;
+        get_value(graph, node->Inputs[1], value);
+        return pointwise_op::scale(value);
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -969,13 +1021,23 @@ Node *Spawn_ImageOperator_ImageDivFloat(const std::function<int()> &GetNextId, c
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             result = image / value;
             node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
 
+    node.OnPointwise = [](Graph *graph, Node *node) -> std::optional<pointwise_op>
+    {
+        float value = 1.0f;
+        get_value(graph, node->Inputs[1], value);
+        // 除以 0 的结果交给节点自己处理
+        if (value == 0)
+            return std::nullopt;
+        return pointwise_op::scale(static_cast<float>(1.0 / value));
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -1005,7 +1067,7 @@ Node *Spawn_ImageOperator_ImageAddImage(const std::function<int()> &GetNextId, c
                 return ExecuteResult::ErrorNode(node->ID, "Images must have the same size");
             if (image_right.channels() != image_left.channels())
                 return ExecuteResult::ErrorNode(node->ID, "Images must have the same number of channels");
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::add(image_right, image_left, result);
             node->Outputs[0].SetValue(result);
         }
@@ -1040,7 +1102,7 @@ Node *Spawn_ImageOperator_ImageSubImage(const std::function<int()> &GetNextId, c
             return ExecuteResult::ErrorNode(node->ID, "Images must have the same size");
         if (image_right.channels() != image_left.channels())
             return ExecuteResult::ErrorNode(node->ID, "Images must have the same number of channels");
-        cv::Mat result;
+        cv::Mat result = node->Outputs[0].take_image_buffer();
         cv::subtract(image_right, image_left, result);
         node->Outputs[0].SetValue(result);
         catch_block_and_return;
@@ -1074,7 +1136,7 @@ Node *Spawn_ImageOperator_ImageMulImage(const std::function<int()> &GetNextId, c
             return ExecuteResult::ErrorNode(node->ID, "Images must have the same size");
         if (image_right.channels() != image_left.channels())
             return ExecuteResult::ErrorNode(node->ID, "Images must have the same number of channels");
-        cv::Mat result;
+        cv::Mat result = node->Outputs[0].take_image_buffer();
         cv::multiply(image_right, image_left, result);
         node->Outputs[0].SetValue(result);
         catch_block_and_return;
@@ -1107,7 +1169,7 @@ Node *Spawn_ImageOperator_ImageDivImage(const std::function<int()> &GetNextId, c
             return ExecuteResult::ErrorNode(node->ID, "Images must have the same size");
         if (image_right.channels() != image_left.channels())
             return ExecuteResult::ErrorNode(node->ID, "Images must have the same number of channels");
-        cv::Mat result;
+        cv::Mat result = node->Outputs[0].take_image_buffer();
         cv::divide(image_right, image_left, result);
         node->Outputs[0].SetValue(result);
         catch_block_and_return;
@@ -1143,7 +1205,7 @@ Node *Spawn_ImageOperator_ImageAndImage(const std::function<int()> &GetNextId, c
             return ExecuteResult::ErrorNode(node->ID, "Images must have the same size");
         if (image_right.channels() != image_left.channels())
             return ExecuteResult::ErrorNode(node->ID, "Images must have the same number of channels");
-        cv::Mat result;
+        cv::Mat result = node->Outputs[0].take_image_buffer();
         cv::bitwise_and(image_right, image_left, result);
         node->Outputs[0].SetValue(result);
         catch_block_and_return;
@@ -1177,7 +1239,7 @@ Node *Spawn_ImageOperator_ImageOrImage(const std::function<int()> &GetNextId, co
             return ExecuteResult::ErrorNode(node->ID, "Images must have the same size");
         if (image_right.channels() != image_left.channels())
             return ExecuteResult::ErrorNode(node->ID, "Images must have the same number of channels");
-        cv::Mat result;
+        cv::Mat result = node->Outputs[0].take_image_buffer();
         cv::bitwise_or(image_right, image_left, result);
         node->Outputs[0].SetValue(result);
         catch_block_and_return;
@@ -1211,7 +1273,7 @@ Node *Spawn_ImageOperator_ImageXorImage(const std::function<int()> &GetNextId, c
             return ExecuteResult::ErrorNode(node->ID, "Images must have the same size");
         if (image_right.channels() != image_left.channels())
             return ExecuteResult::ErrorNode(node->ID, "Images must have the same number of channels");
-        cv::Mat result;
+        cv::Mat result = node->Outputs[0].take_image_buffer();
         cv::bitwise_xor(image_right, image_left, result);
         node->Outputs[0].SetValue(result);
         catch_block_and_return;
@@ -1237,7 +1299,7 @@ Node *Spawn_ImageOperator_ImageNotImage(const std::function<int()> &GetNextId, c
         get_value(graph, node->Inputs[0], image);
 
         try_catch_block;
-        cv::Mat result;
+        cv::Mat result = node->Outputs[0].take_image_buffer();
         cv::bitwise_not(image, result);
         node->Outputs[0].SetValue(result);
         catch_block_and_return;
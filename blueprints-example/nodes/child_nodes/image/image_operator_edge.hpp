@@ -30,7 +30,7 @@ Node *Spawn_ImageOperator_Canny(const std::function<int()> &GetNextId, const std
         {
             if (size % 2 == 0)
                 return ExecuteResult::ErrorNode(node->ID, "Size must be odd");
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::Canny(image, result, threshold_1, threshold_2, size);
             node->Outputs[0].SetValue(result);
         }
@@ -59,7 +59,7 @@ Node *Spawn_ImageOperator_SobelEdgeDetection(const std::function<int()> &GetNext
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::Mat grad_x, grad_y;
             cv::Mat abs_grad_x, abs_grad_y;
             cv::Sobel(image, grad_x, CV_16S, 1, 0, 3, 1, 0, cv::BORDER_DEFAULT);
@@ -73,6 +73,19 @@ Node *Spawn_ImageOperator_SobelEdgeDetection(const std::function<int()> &GetNext
         catch_block_and_return;
     };
 
+    node.OnLocal = [](Graph *graph, Node *node, int input_type) -> std::optional<local_op>
+    {
+        return local_op::square(1, cv::BORDER_DEFAULT, [](const cv::Mat &src, cv::Mat &dst)
+                                {
+            cv::Mat grad_x, grad_y;
+            cv::Mat abs_grad_x, abs_grad_y;
+            cv::Sobel(src, grad_x, CV_16S, 1, 0, 3, 1, 0, cv::BORDER_DEFAULT);
+            cv::Sobel(src, grad_y, CV_16S, 0, 1, 3, 1, 0, cv::BORDER_DEFAULT);
+            cv::convertScaleAbs(grad_x, abs_grad_x);
+            cv::convertScaleAbs(grad_y, abs_grad_y);
+            cv::addWeighted(abs_grad_x, 0.5, abs_grad_y, 0.5, 0, dst); }, CV_8U);
+    };
+
     BuildNode(&node);
     return &node;
 }
@@ -110,7 +123,7 @@ Node *Spawn_ImageOperator_LaplacianEdgeDetection(const std::function<int()> &Get
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::Laplacian(image, result, ddepth, ksize, scale, delta, borderType);
             // cv::convertScaleAbs(result, result);
 
@@ -119,6 +132,26 @@ Node *Spawn_ImageOperator_LaplacianEdgeDetection(const std::function<int()> &Get
         catch_block_and_return;
     };
 
+    node.OnLocal = [](Graph *graph, Node *node, int input_type) -> std::optional<local_op>
+    {
+        int ddepth = CV_16S;
+        get_value(graph, node->Inputs[1], ddepth);
+        int ksize = 3;
+        get_value(graph, node->Inputs[2], ksize);
+        float scale = 1.0f;
+        get_value(graph, node->Inputs[3], scale);
+        float delta = 0.0f;
+        get_value(graph, node->Inputs[4], delta);
+        int borderType = cv::BORDER_DEFAULT;
+        get_value(graph, node->Inputs[5], borderType);
+
+        if (ksize <= 0 || ksize % 2 == 0)
+            return std::nullopt;
+        // ksize 为 1 时使用 3x3 的卷积核
+        return local_op::square(std::max(ksize / 2, 1), borderType, [=](const cv::Mat &src, cv::Mat &dst)
+                                { cv::Laplacian(src, dst, ddepth, ksize, scale, delta, borderType); }, ddepth);
+    };
+
     BuildNode(&node);
     return &node;
 }
@@ -158,7 +191,7 @@ Node *Spawn_ImageOperator_LaplacianEdgeEnhancement(const std::function<int()> &G
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::Mat laplacian;
             cv::Laplacian(image, laplacian, ddepth, ksize, scale, delta, borderType);
             cv::convertScaleAbs(laplacian, laplacian);
@@ -189,7 +222,7 @@ Node *Spawn_ImageOperator_ScharrEdgeDetection(const std::function<int()> &GetNex
 
         try_catch_block
         {
-            cv::Mat result;
+            cv::Mat result = node->Outputs[0].take_image_buffer();
             cv::Mat grad_x, grad_y;
             cv::Mat abs_grad_x, abs_grad_y;
             cv::Scharr(image, grad_x, CV_16S, 1, 0, 1, 0, cv::BORDER_DEFAULT);
@@ -203,6 +236,19 @@ Node *Spawn_ImageOperator_ScharrEdgeDetection(const std::function<int()> &GetNex
         catch_block_and_return;
     };
 
+    node.OnLocal = [](Graph *graph, Node *node, int input_type) -> std::optional<local_op>
+    {
+        return local_op::square(1, cv::BORDER_DEFAULT, [](const cv::Mat &src, cv::Mat &dst)
+                                {
+            cv::Mat grad_x, grad_y;
+            cv::Mat abs_grad_x, abs_grad_y;
+            cv::Scharr(src, grad_x, CV_16S, 1, 0, 1, 0, cv::BORDER_DEFAULT);
+            cv::Scharr(src, grad_y, CV_16S, 0, 1, 1, 0, cv::BORDER_DEFAULT);
+            cv::convertScaleAbs(grad_x, abs_grad_x);
+            cv::convertScaleAbs(grad_y, abs_grad_y);
+            cv::addWeighted(abs_grad_x, 0.5, abs_grad_y, 0.5, 0, dst); }, CV_8U);
+    };
+
     BuildNode(&node);
     return &node;
 }
@@ -227,7 +273,7 @@ Node *Spawn_ImageOperator_FindContours(const std::function<int()> &GetNextId, co
             std::vector<cv::Vec4i> hierarchy;
             cv::findContours(image, contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_SIMPLE);
 
-            node->Outputs[0].SetValue(contours);
+            node->Outputs[0].SetValue(std::move(contours));
         }
         catch_block_and_return;
     };
@@ -254,7 +300,7 @@ Node *Spawn_ImageOperator_DrawContours(const std::function<int()> &GetNextId, co
         cv::Mat image;
         get_value(graph, node->Inputs[0], image);
 
-        std::vector<std::vector<cv::Point>> contours;
+        shared_value<Contours> contours;
         auto result2 = get_value(graph, node->Inputs[1], contours);
         if (result2.has_error())
             return result2;
@@ -272,15 +318,16 @@ Node *Spawn_ImageOperator_DrawContours(const std::function<int()> &GetNextId, co
             cv::Mat result = image.clone();
             if (random_color)
             {
-                for (size_t i = 0; i < contours.size(); i++)
+                for (size_t i = 0; i < contours->size(); i++)
                 {
+                    return_if_cancelled;
                     cv::Scalar color(rand() & 255, rand() & 255, rand() & 255);
-                    cv::drawContours(result, contours, static_cast<int>(i), color, thickness);
+                    cv::drawContours(result, *contours, static_cast<int>(i), color, thickness);
                 }
             }
             else
             {
-                cv::drawContours(result, contours, -1, color, thickness);
+                cv::drawContours(result, *contours, -1, color, thickness);
             }
             node->Outputs[0].SetValue(result);
         }
@@ -310,7 +357,7 @@ Node *Spawn_ImageOperator_SortContoursByArea(const std::function<int()> &GetNext
             std::sort(contours.begin(), contours.end(), [](const std::vector<cv::Point> &a, const std::vector<cv::Point> &b)
                       { return cv::contourArea(a) > cv::contourArea(b); });
 
-            node->Outputs[0].SetValue(contours);
+            node->Outputs[0].SetValue(std::move(contours));
         }
         catch_block_and_return;
     };
@@ -332,7 +379,7 @@ Node *Spawn_ImageOperator_FilterContoursByAreaRange(const std::function<int()> &
 
     node.OnExecute = [](Graph *graph, Node *node) -> ExecuteResult
     {
-        std::vector<std::vector<cv::Point>> contours;
+        shared_value<Contours> contours;
         get_value(graph, node->Inputs[0], contours);
 
         int min_area = 0;
@@ -348,14 +395,14 @@ Node *Spawn_ImageOperator_FilterContoursByAreaRange(const std::function<int()> &
         try_catch_block
         {
             std::vector<std::vector<cv::Point>> filtered_contours;
-            for (auto &contour : contours)
+            for (auto &contour : *contours)
             {
                 double area = cv::contourArea(contour);
                 if (area >= min_area && area <= max_area)
                     filtered_contours.push_back(contour);
             }
 
-            node->Outputs[0].SetValue(filtered_contours);
+            node->Outputs[0].SetValue(std::move(filtered_contours));
         }
         catch_block_and_return;
     };
@@ -375,7 +422,7 @@ Node *Spawn_ImageOperator_SelectContourByIndex(const std::function<int()> &GetNe
 
     node.OnExecute = [](Graph *graph, Node *node) -> ExecuteResult
     {
-        std::vector<std::vector<cv::Point>> contours;
+        shared_value<Contours> contours;
         get_value(graph, node->Inputs[0], contours);
 
         int index = 0;
@@ -385,11 +432,11 @@ Node *Spawn_ImageOperator_SelectContourByIndex(const std::function<int()> &GetNe
 
         try_catch_block
         {
-            if (index >= 0 && index < contours.size())
+            if (index >= 0 && index < contours->size())
             {
                 std::vector<std::vector<cv::Point>> selected_contour;
-                selected_contour.push_back(contours[index]);
-                node->Outputs[0].SetValue(selected_contour);
+                selected_contour.push_back((*contours)[index]);
+                node->Outputs[0].SetValue(std::move(selected_contour));
             }
         }
         catch_block_and_return;
@@ -440,7 +487,7 @@ Node *Spawn_ImageOperator_HoughCircleDetection(const std::function<int()> &GetNe
             std::vector<cv::Vec3f> circles;
             cv::HoughCircles(image, circles, method, dp, minDist, param1, param2, minRadius, maxRadius);
 
-            node->Outputs[0].SetValue(circles);
+            node->Outputs[0].SetValue(std::move(circles));
         }
         catch_block_and_return;
     };
@@ -466,7 +513,7 @@ Node *Spawn_ImageOperator_DrawHoughCircles(const std::function<int()> &GetNextId
         cv::Mat image;
         get_value(graph, node->Inputs[0], image);
 
-        std::vector<cv::Vec3f> circles;
+        shared_value<Circles> circles;
         auto result2 = get_value(graph, node->Inputs[1], circles);
         if (result2.has_error())
             return result2;
@@ -479,14 +526,17 @@ Node *Spawn_ImageOperator_DrawHoughCircles(const std::function<int()> &GetNextId
 
         try_catch_block
         {
-            for (size_t i = 0; i < circles.size(); i++)
+            // 输入图像和上游共享，在副本上绘制
+            cv::Mat result = image.clone();
+            for (auto &circle : *circles)
             {
-                cv::Point center(cvRound(circles[i][0]), cvRound(circles[i][1]));
-                int radius = cvRound(circles[i][2]);
-                cv::circle(image, center, radius, color, thickness);
+                return_if_cancelled;
+                cv::Point center(cvRound(circle[0]), cvRound(circle[1]));
+                int radius = cvRound(circle[2]);
+                cv::circle(result, center, radius, color, thickness);
             }
 
-            node->Outputs[0].SetValue(image);
+            node->Outputs[0].SetValue(result);
         }
         catch_block_and_return;
     };
@@ -21,7 +21,7 @@ Node *Spawn_ImageOperator_Dilate(const std::function<int()> &GetNextId, const st
 
         try_catch_block
         {
-            cv::Mat dilate;
+            cv::Mat dilate = node->Outputs[0].take_image_buffer();
             cv::Mat element = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernel_size, kernel_size));
             cv::dilate(image, dilate, element);
             node->Outputs[0].SetValue(dilate);
@@ -29,6 +29,20 @@ Node *Spawn_ImageOperator_Dilate(const std::function<int()> &GetNextId, const st
         catch_block_and_return;
     };
 
+    node.OnLocal = [](Graph *graph, Node *node, int input_type) -> std::optional<local_op>
+    {
+        int kernel_size = 3;
+        get_value(graph, node->Inputs[1], kernel_size);
+
+        if (kernel_size <= 0)
+            return std::nullopt;
+        // 矩形结构元素下复制边缘像素和默认的边界值结果相同：复制来的像素本来就在窗口内
+        return local_op::square(kernel_size / 2, cv::BORDER_REPLICATE, [=](const cv::Mat &src, cv::Mat &dst)
+                                {
+            cv::Mat element = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernel_size, kernel_size));
+            cv::dilate(src, dst, element); });
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -54,7 +68,7 @@ Node *Spawn_ImageOperator_Erode(const std::function<int()> &GetNextId, const std
 
         try_catch_block
         {
-            cv::Mat erode;
+            cv::Mat erode = node->Outputs[0].take_image_buffer();
             cv::Mat element = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernel_size, kernel_size));
             cv::erode(image, erode, element);
             node->Outputs[0].SetValue(erode);
@@ -62,6 +76,20 @@ Node *Spawn_ImageOperator_Erode(const std::function<int()> &GetNextId, const std
         catch_block_and_return;
     };
 
+    node.OnLocal = [](Graph *graph, Node *node, int input_type) -> std::optional<local_op>
+    {
+        int kernel_size = 3;
+        get_value(graph, node->Inputs[1], kernel_size);
+
+        if (kernel_size <= 0)
+            return std::nullopt;
+        // 矩形结构元素下复制边缘像素和默认的边界值结果相同：复制来的像素本来就在窗口内
+        return local_op::square(kernel_size / 2, cv::BORDER_REPLICATE, [=](const cv::Mat &src, cv::Mat &dst)
+                                {
+            cv::Mat element = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernel_size, kernel_size));
+            cv::erode(src, dst, element); });
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -87,7 +115,7 @@ Node *Spawn_ImageOperator_MorphologyOpen(const std::function<int()> &GetNextId,
 
         try_catch_block
         {
-            cv::Mat open;
+            cv::Mat open = node->Outputs[0].take_image_buffer();
             cv::Mat element = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernel_size, kernel_size));
             cv::morphologyEx(image, open, cv::MORPH_OPEN, element);
             node->Outputs[0].SetValue(open);
@@ -120,7 +148,7 @@ Node *Spawn_ImageOperator_MorphologyClose(const std::function<int()> &GetNextId,
 
         try_catch_block
         {
-            cv::Mat close;
+            cv::Mat close = node->Outputs[0].take_image_buffer();
             cv::Mat element = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernel_size, kernel_size));
             cv::morphologyEx(image, close, cv::MORPH_CLOSE, element);
             node->Outputs[0].SetValue(close);
@@ -153,7 +181,7 @@ Node *Spawn_ImageOperator_MorphologyGradient(const std::function<int()> &GetNext
 
         try_catch_block
         {
-            cv::Mat gradient;
+            cv::Mat gradient = node->Outputs[0].take_image_buffer();
             cv::Mat element = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernel_size, kernel_size));
             cv::morphologyEx(image, gradient, cv::MORPH_GRADIENT, element);
             node->Outputs[0].SetValue(gradient);
@@ -186,7 +214,7 @@ Node *Spawn_ImageOperator_MorphologyTopHat(const std::function<int()> &GetNextId
 
         try_catch_block
         {
-            cv::Mat top_hat;
+            cv::Mat top_hat = node->Outputs[0].take_image_buffer();
             cv::Mat element = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernel_size, kernel_size));
             cv::morphologyEx(image, top_hat, cv::MORPH_TOPHAT, element);
             node->Outputs[0].SetValue(top_hat);
@@ -219,7 +247,7 @@ Node *Spawn_ImageOperator_MorphologyBlackHat(const std::function<int()> &GetNext
 
         try_catch_block
         {
-            cv::Mat black_hat;
+            cv::Mat black_hat = node->Outputs[0].take_image_buffer();
             cv::Mat element = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernel_size, kernel_size));
             cv::morphologyEx(image, black_hat, cv::MORPH_BLACKHAT, element);
             node->Outputs[0].SetValue(black_hat);
@@ -28,12 +28,34 @@ Node *Spawn_ImageOperator_Threshold(const std::function<int()> &GetNextId, const
         get_value(graph, node->Inputs[3], type);
 
         try_catch_block;
-        cv::Mat thresholded;
+        cv::Mat thresholded = node->Outputs[0].take_image_buffer();
         cv::threshold(image, thresholded, threshold, max_value, type);
         node->Outputs[0].SetValue(thresholded);
         catch_block_and_return;
     };
 
+    node.OnLocal = [](Graph *graph, Node *node, int input_type) -> std::optional<local_op>
+    {
+        int threshold = 128;
+        get_value(graph, node->Inputs[1], threshold);
+
+        int max_value = 255;
+        get_value(graph, node->Inputs[2], max_value);
+
+        int type = cv::THRESH_BINARY;
+        get_value(graph, node->Inputs[3], type);
+
+        // 自动阈值依赖整幅图像的直方图，不能分块
+        if (type & (cv::THRESH_OTSU | cv::THRESH_TRIANGLE))
+            return std::nullopt;
+        // threshold 不支持有符号 8 位和 32 位整数图像，不支持的类型逐个执行，由节点自己报告错误
+        int depth = CV_MAT_DEPTH(input_type);
+        if (depth == CV_8S || depth == CV_32S)
+            return std::nullopt;
+        return local_op::square(0, cv::BORDER_DEFAULT, [=](const cv::Mat &src, cv::Mat &dst)
+                                { cv::threshold(src, dst, threshold, max_value, type); });
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -69,12 +91,36 @@ Node *Spawn_ImageOperator_AdaptiveThreshold(const std::function<int()> &GetNextI
         get_value(graph, node->Inputs[4], c);
 
         try_catch_block;
-        cv::Mat thresholded;
+        cv::Mat thresholded = node->Outputs[0].take_image_buffer();
         cv::adaptiveThreshold(image, thresholded, max_value, type, cv::THRESH_BINARY, block_size, c);
         node->Outputs[0].SetValue(thresholded);
         catch_block_and_return;
     };
 
+    node.OnLocal = [](Graph *graph, Node *node, int input_type) -> std::optional<local_op>
+    {
+        int max_value = 255;
+        get_value(graph, node->Inputs[1], max_value);
+
+        int type = cv::ADAPTIVE_THRESH_MEAN_C;
+        get_value(graph, node->Inputs[2], type);
+
+        int block_size = 11;
+        get_value(graph, node->Inputs[3], block_size);
+
+        int c = 2;
+        get_value(graph, node->Inputs[4], c);
+
+        if (block_size <= 1 || block_size % 2 == 0)
+            return std::nullopt;
+        // adaptiveThreshold 只支持 8 位单通道图像
+        if (input_type != CV_8UC1)
+            return std::nullopt;
+        // adaptiveThreshold 计算邻域均值时在边界外复制边缘像素
+        return local_op::square(block_size / 2, cv::BORDER_REPLICATE, [=](const cv::Mat &src, cv::Mat &dst)
+                                { cv::adaptiveThreshold(src, dst, max_value, type, cv::THRESH_BINARY, block_size, c); }, CV_8U);
+    };
+
     BuildNode(&node);
 
     return &node;
@@ -141,7 +187,7 @@ Node *Spawn_ImageOperator_ChannelThresholding(const std::function<int()> &GetNex
 
         try_catch_block
         {
-            cv::Mat thresholded;
+            cv::Mat thresholded = node->Outputs[0].take_image_buffer();
             std::vector<cv::Mat> channels;
             cv::split(image, channels);
             if (channels.size() > 0)
@@ -186,7 +232,7 @@ Node *Spawn_ImageOperator_InRange(const std::function<int()> &GetNextId, const s
         get_value(graph, node->Inputs[2], upper_bound);
 
         try_catch_block;
-        cv::Mat thresholded;
+        cv::Mat thresholded = node->Outputs[0].take_image_buffer();
         cv::inRange(image, lower_bound, upper_bound, thresholded);
         node->Outputs[0].SetValue(thresholded);
         catch_block_and_return;
@@ -2,6 +2,7 @@
 
 #include <filesystem>
 
+#ifndef IMAGE_NODE_HEADLESS
 #ifdef _WIN32
 #include <Windows.h>
 #else
@@ -11,8 +12,11 @@
 #endif
 
 #include "convert.string.h"
+#endif
 #include "utils.string.h"
 
+#ifndef IMAGE_NODE_HEADLESS
+
 namespace window_scale
 {
     namespace window_last_version
@@ -90,6 +94,7 @@ Node *Spawn_ImageWindowBitbltCapture(const std::function<int()> &GetNextId, cons
     m_Nodes.emplace_back(GetNextId(), "窗口原生截图");
     auto &node = m_Nodes.back();
     node.Type = NodeType::ImageSource;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), "窗口名称", PinType::String, std::string());
     node.Inputs.emplace_back(GetNextId(), "窗口类名", PinType::String, std::string());
     node.Outputs.emplace_back(GetNextId(), PinType::Image);
@@ -159,6 +164,7 @@ Node *Spawn_ImageWindowGraphicCapture(const std::function<int()> &GetNextId, con
     m_Nodes.emplace_back(GetNextId(), "窗口图形截图");
     auto &node = m_Nodes.back();
     node.Type = NodeType::ImageSource;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), "窗口名称", PinType::String, std::string());
     node.Inputs.emplace_back(GetNextId(), "窗口类名", PinType::String, std::string());
     node.Outputs.emplace_back(GetNextId(), PinType::Image);
@@ -208,12 +214,15 @@ Node *Spawn_ImageWindowGraphicCapture(const std::function<int()> &GetNextId, con
     return &node;
 }
 
+#endif // IMAGE_NODE_HEADLESS
+
 // local images from dir
 Node *Spawn_ImageLocalImagesFromDir(const std::function<int()> &GetNextId, const std::function<void(Node *)> &BuildNode, std::vector<Node> &m_Nodes, Application *app)
 {
     m_Nodes.emplace_back(GetNextId(), "本地图片列表");
     auto &node = m_Nodes.back();
     node.Type = NodeType::ImageSource;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), "目录", PinType::String, std::string("."));
     node.Inputs.emplace_back(GetNextId(), "上次输出索引", PinType::Int, 0);
     node.Inputs.emplace_back(GetNextId(), "是否锁定图片", PinType::Bool, false);
@@ -252,6 +261,8 @@ Node *Spawn_ImageLocalImagesFromDir(const std::function<int()> &GetNextId, const
         std::vector<std::filesystem::path> images;
         for (auto &entry : std::filesystem::directory_iterator(images_dir))
         {
+            // 目录中文件很多时遍历耗时较长，每个条目检查一次是否取消
+            return_if_cancelled;
             if (entry.is_directory())
                 continue;
             if (suffixes_set.find(entry.path().extension().string()) == suffixes_set.end())
@@ -272,7 +283,7 @@ Node *Spawn_ImageLocalImagesFromDir(const std::function<int()> &GetNextId, const
 
         int next_index = index + (int)(lock ? 0 : 1);
 
-        node->Inputs[1].Value = next_index;
+        node->Inputs[1].SetValue(next_index);
 
         node->Outputs[0].SetValue(result);
         node->Outputs[1].SetValue(index);
@@ -291,6 +302,7 @@ Node *Spawn_ImageFileSource(const std::function<int()> &GetNextId, const std::fu
     m_Nodes.emplace_back(GetNextId(), "图像文件源");
     auto &node = m_Nodes.back();
     node.Type = NodeType::ImageFlow;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), PinType::String, "图像路径", std::string("resources/texture.png"));
     node.Outputs.emplace_back(GetNextId(), PinType::Image);
 
@@ -311,6 +323,10 @@ Node *Spawn_ImageFileSource(const std::function<int()> &GetNextId, const std::fu
         catch_block_and_return;
     };
 
+    node.ast.code = "$1 = cv::imread($0, cv::IMREAD_UNCHANGED);"
+                    "if ($1.empty()) return false;";
+    node.ast.add_params({"path", "image"});
+
     BuildNode(&node);
 
     return &node;
@@ -322,6 +338,7 @@ Node *Spawn_ImageRawFileSource(const std::function<int()> &GetNextId, const std:
     m_Nodes.emplace_back(GetNextId(), "图像Raw数据源");
     auto &node = m_Nodes.back();
     node.Type = NodeType::ImageFlow;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), PinType::String, "图像路径", std::string("resources/texture.png"));
     node.Inputs.emplace_back(GetNextId(), PinType::Int, "宽度", 256);
     node.Inputs.emplace_back(GetNextId(), PinType::Int, "高度", 256);
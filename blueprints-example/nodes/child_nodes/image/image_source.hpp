@@ -1,10 +1,13 @@
 #pragma once
 #include "base_nodes.hpp"
 
+// 窗口截图节点依赖 Windows，命令行工具中不包含
+#ifndef IMAGE_NODE_HEADLESS
 // window bitblt capture
 Node *Spawn_ImageWindowBitbltCapture(const std::function<int()> &GetNextId, const std::function<void(Node *)> &BuildNode, std::vector<Node> &m_Nodes, Application *app);
 // window graphic capture
 Node *Spawn_ImageWindowGraphicCapture(const std::function<int()> &GetNextId, const std::function<void(Node *)> &BuildNode, std::vector<Node> &m_Nodes, Application *app);
+#endif
 // local images from dir
 Node *Spawn_ImageLocalImagesFromDir(const std::function<int()> &GetNextId, const std::function<void(Node *)> &BuildNode, std::vector<Node> &m_Nodes, Application *app);
 
@@ -13,16 +16,20 @@ Node *Spawn_ImageFileSource(const std::function<int()> &GetNextId, const std::fu
 Node *Spawn_ImageRawFileSource(const std::function<int()> &GetNextId, const std::function<void(Node *)> &BuildNode, std::vector<Node> &m_Nodes, Application *app);
 
 static NodeWorldGlobal::FactoryGroupFunc_t ImageSourceNodes = {
+#ifndef IMAGE_NODE_HEADLESS
     {"窗口原生截图", Spawn_ImageWindowBitbltCapture},
     {"窗口图形截图", Spawn_ImageWindowGraphicCapture},
+#endif
     {"本地图片列表", Spawn_ImageLocalImagesFromDir},
     {"图像文件源", Spawn_ImageFileSource},
     {"图像Raw数据源", Spawn_ImageRawFileSource},
 };
 
 static std::vector<std::pair<std::string, factory_func_t>> ImageSourceNodesFactorys = {
+#ifndef IMAGE_NODE_HEADLESS
     {"图像/源/窗口原生截图", Spawn_ImageWindowBitbltCapture},
     {"图像/源/窗口图形截图", Spawn_ImageWindowGraphicCapture},
+#endif
     {"图像/源/本地图片列表", Spawn_ImageLocalImagesFromDir},
     {"图像/源/图像文件源", Spawn_ImageFileSource},
     {"图像/源/图像Raw数据源", Spawn_ImageRawFileSource},
@@ -3,22 +3,26 @@
 // #include <json.hpp>
 
 #define auto_resize_outputs(output_count)                                               \
+    return_if_cancelled;                                                                \
     if (output_count <= 0)                                                              \
         return ExecuteResult::ErrorNode(node->ID, "next Task 数量必须大于0");           \
     if (output_count < node->Outputs.size())                                            \
     {                                                                                   \
         node->Outputs.erase(node->Outputs.begin() + output_count, node->Outputs.end()); \
+        graph->invalidate_index();                                                      \
     }                                                                                   \
     if (output_count > node->Outputs.size())                                            \
     {                                                                                   \
         for (int i = 0; i < output_count; i++)                                          \
         {                                                                               \
+            return_if_cancelled;                                                        \
             if (i < node->Outputs.size())                                               \
                 continue;                                                               \
             std::string name = "next " + std::to_string(i + 1);                         \
             node->Outputs.emplace_back(graph->get_next_id(), PinType::Flow, name);      \
             node->Outputs[node->Outputs.size() - 1].app = graph->env.app;               \
         }                                                                               \
+        graph->invalidate_index();                                                      \
     }
 
 struct maa_base_node_state_value : public node_state_value
@@ -31,6 +35,7 @@ Node *Spawn_Maa_StartupTask(const std::function<int()> &GetNextId, const std::fu
     m_Nodes.emplace_back(GetNextId(), "maa 入口任务");
     auto &node = m_Nodes.back();
     node.Type = NodeType::MaaTaskFlow;
+    node.AlwaysExecute = true;
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::String, "Task名称", std::string("Startup Task")));
     node.Inputs.push_back(Pin(GetNextId(), PinType::Int, "next Task 数量", 1));
@@ -98,6 +103,7 @@ Node *Spawn_Maa_DirectHitTask(const std::function<int()> &GetNextId, const std::
     m_Nodes.emplace_back(GetNextId(), "maa 直接命中任务");
     auto &node = m_Nodes.back();
     node.Type = NodeType::MaaTaskFlow;
+    node.AlwaysExecute = true;
     node.Inputs.push_back(Pin(GetNextId(), PinType::Flow, "依赖"));
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::String, "Task名称", std::string("Ocr Task")));
@@ -140,7 +146,7 @@ Node *Spawn_Maa_DirectHitTask(const std::function<int()> &GetNextId, const std::
         int next_task_count;
         get_value(graph, node->Inputs[10], next_task_count);
 
-        node->Inputs[10].Value = next_task_count;
+        node->Inputs[10].SetValue(next_task_count);
 
         try_catch_block
         {
@@ -165,6 +171,7 @@ Node *Spawn_Maa_TemplateMatchTask(const std::function<int()> &GetNextId, const s
     m_Nodes.emplace_back(GetNextId(), "maa 模板匹配任务");
     auto &node = m_Nodes.back();
     node.Type = NodeType::MaaTaskFlow;
+    node.AlwaysExecute = true;
     node.Inputs.push_back(Pin(GetNextId(), PinType::Flow, "依赖"));
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::String, "Task名称", std::string("Ocr Task")));
@@ -207,7 +214,7 @@ Node *Spawn_Maa_TemplateMatchTask(const std::function<int()> &GetNextId, const s
         int next_task_count;
         get_value(graph, node->Inputs[10], next_task_count);
 
-        node->Inputs[10].Value = next_task_count;
+        node->Inputs[10].SetValue(next_task_count);
 
         try_catch_block
         {
@@ -232,6 +239,7 @@ Node *Spawn_Maa_FeatureMatchTask(const std::function<int()> &GetNextId, const st
     m_Nodes.emplace_back(GetNextId(), "maa 特征匹配任务");
     auto &node = m_Nodes.back();
     node.Type = NodeType::MaaTaskFlow;
+    node.AlwaysExecute = true;
     node.Inputs.push_back(Pin(GetNextId(), PinType::Flow, "依赖"));
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::String, "Task名称", std::string("Ocr Task")));
@@ -274,7 +282,7 @@ Node *Spawn_Maa_FeatureMatchTask(const std::function<int()> &GetNextId, const st
         int next_task_count;
         get_value(graph, node->Inputs[10], next_task_count);
 
-        node->Inputs[10].Value = next_task_count;
+        node->Inputs[10].SetValue(next_task_count);
 
         try_catch_block
         {
@@ -299,6 +307,7 @@ Node *Spawn_Maa_ColorMatchTask(const std::function<int()> &GetNextId, const std:
     m_Nodes.emplace_back(GetNextId(), "maa 颜色匹配任务");
     auto &node = m_Nodes.back();
     node.Type = NodeType::MaaTaskFlow;
+    node.AlwaysExecute = true;
     node.Inputs.push_back(Pin(GetNextId(), PinType::Flow, "依赖"));
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::String, "Task名称", std::string("Ocr Task")));
@@ -341,7 +350,7 @@ Node *Spawn_Maa_ColorMatchTask(const std::function<int()> &GetNextId, const std:
         int next_task_count;
         get_value(graph, node->Inputs[10], next_task_count);
 
-        node->Inputs[10].Value = next_task_count;
+        node->Inputs[10].SetValue(next_task_count);
 
         try_catch_block
         {
@@ -366,6 +375,7 @@ Node *Spawn_Maa_OcrTask(const std::function<int()> &GetNextId, const std::functi
     m_Nodes.emplace_back(GetNextId(), "maa OCR 任务");
     auto &node = m_Nodes.back();
     node.Type = NodeType::MaaTaskFlow;
+    node.AlwaysExecute = true;
     node.Inputs.push_back(Pin(GetNextId(), PinType::Flow, "依赖"));
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::String, "Task名称", std::string("Ocr Task")));
@@ -408,7 +418,7 @@ Node *Spawn_Maa_OcrTask(const std::function<int()> &GetNextId, const std::functi
         int next_task_count;
         get_value(graph, node->Inputs[10], next_task_count);
 
-        node->Inputs[10].Value = next_task_count;
+        node->Inputs[10].SetValue(next_task_count);
 
         try_catch_block
         {
@@ -434,6 +444,7 @@ Node *Spawn_Maa_NeuralNetworkClassifyTask(const std::function<int()> &GetNextId,
     m_Nodes.emplace_back(GetNextId(), "maa 神经网络分类任务");
     auto &node = m_Nodes.back();
     node.Type = NodeType::MaaTaskFlow;
+    node.AlwaysExecute = true;
     node.Inputs.push_back(Pin(GetNextId(), PinType::Flow, "依赖"));
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::String, "Task名称", std::string("Ocr Task")));
@@ -476,7 +487,7 @@ Node *Spawn_Maa_NeuralNetworkClassifyTask(const std::function<int()> &GetNextId,
         int next_task_count;
         get_value(graph, node->Inputs[10], next_task_count);
 
-        node->Inputs[10].Value = next_task_count;
+        node->Inputs[10].SetValue(next_task_count);
 
         try_catch_block
         {
@@ -501,6 +512,7 @@ Node *Spawn_Maa_NeuralNetworkDetectTask(const std::function<int()> &GetNextId, c
     m_Nodes.emplace_back(GetNextId(), "maa 神经网络检测任务");
     auto &node = m_Nodes.back();
     node.Type = NodeType::MaaTaskFlow;
+    node.AlwaysExecute = true;
     node.Inputs.push_back(Pin(GetNextId(), PinType::Flow, "依赖"));
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::String, "Task名称", std::string("Ocr Task")));
@@ -543,7 +555,7 @@ Node *Spawn_Maa_NeuralNetworkDetectTask(const std::function<int()> &GetNextId, c
         int next_task_count;
         get_value(graph, node->Inputs[10], next_task_count);
 
-        node->Inputs[10].Value = next_task_count;
+        node->Inputs[10].SetValue(next_task_count);
 
         try_catch_block
         {
@@ -568,6 +580,7 @@ Node *Spawn_Maa_CustomTask(const std::function<int()> &GetNextId, const std::fun
     m_Nodes.emplace_back(GetNextId(), "maa 自定义任务");
     auto &node = m_Nodes.back();
     node.Type = NodeType::MaaTaskFlow;
+    node.AlwaysExecute = true;
     node.Inputs.push_back(Pin(GetNextId(), PinType::Flow, "依赖"));
 
     node.Inputs.push_back(Pin(GetNextId(), PinType::String, "Task名称", std::string("Ocr Task")));
@@ -610,7 +623,7 @@ Node *Spawn_Maa_CustomTask(const std::function<int()> &GetNextId, const std::fun
         int next_task_count;
         get_value(graph, node->Inputs[10], next_task_count);
 
-        node->Inputs[10].Value = next_task_count;
+        node->Inputs[10].SetValue(next_task_count);
 
         try_catch_block
         {
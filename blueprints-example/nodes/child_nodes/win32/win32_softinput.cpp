@@ -124,6 +124,7 @@ Node *Spawn_Win32_SoftInput_MouseClick(const std::function<int()> &GetNextId, co
     m_Nodes.emplace_back(GetNextId(), "Win32 软件鼠标点击");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), PinType::Win32Handle, "窗口句柄");
     node.Inputs.emplace_back(GetNextId(), PinType::Point);
     node.Inputs.emplace_back(GetNextId(), PinType::Enum, "按键", EnumValue{MouseClickType, 0});
@@ -204,7 +205,7 @@ Node *Spawn_Win32_SoftInput_MouseClick(const std::function<int()> &GetNextId, co
             }
 
             // node->Outputs[0].Value = res != 0;
-            node->Outputs[1].Value = (int)GetLastError();
+            node->Outputs[1].SetValue((int)GetLastError());
         }
         catch_block_and_return;
     };
@@ -218,6 +219,7 @@ Node *Spawn_Win32_SoftInput_MouseMove(const std::function<int()> &GetNextId, con
     m_Nodes.emplace_back(GetNextId(), "Win32 软件鼠标移动");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), PinType::Win32Handle, "窗口句柄");
     node.Inputs.emplace_back(GetNextId(), PinType::Point);
     node.Inputs.emplace_back(GetNextId(), PinType::Bool, "是否相对坐标", false);
@@ -250,7 +252,7 @@ Node *Spawn_Win32_SoftInput_MouseMove(const std::function<int()> &GetNextId, con
                 simulator.GetMouseSimulator().MoveMouseTo(point.x, point.y);
 
             // node->Outputs[0].Value = res != 0;
-            node->Outputs[1].Value = (int)GetLastError();
+            node->Outputs[1].SetValue((int)GetLastError());
         }
         catch_block_and_return;
     };
@@ -264,6 +266,7 @@ Node *Spawn_Win32_SoftInput_MouseWheel(const std::function<int()> &GetNextId, co
     m_Nodes.emplace_back(GetNextId(), "Win32 软件鼠标滚轮");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), PinType::Win32Handle, "窗口句柄");
     node.Inputs.emplace_back(GetNextId(), PinType::Int, "滚动值");
     node.Inputs.emplace_back(GetNextId(), PinType::Int, "等待毫秒", 0);
@@ -295,7 +298,7 @@ Node *Spawn_Win32_SoftInput_MouseWheel(const std::function<int()> &GetNextId, co
             else
                 simulator.GetMouseSimulator().VerticalScroll(delta);
 
-            node->Outputs[1].Value = (int)GetLastError();
+            node->Outputs[1].SetValue((int)GetLastError());
         }
         catch_block_and_return;
     };
@@ -309,6 +312,7 @@ Node *Spawn_Win32_SoftInput_KeyClick(const std::function<int()> &GetNextId, cons
     m_Nodes.emplace_back(GetNextId(), "Win32 软件键盘按键");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), PinType::Win32Handle, "窗口句柄");
     node.Inputs.emplace_back(GetNextId(), PinType::String, "按键", std::string("A"));
     node.Inputs.emplace_back(GetNextId(), PinType::Enum, "动作", EnumValue{KeyClickActionType, 2});
@@ -396,6 +400,7 @@ Node *Spawn_Win32_PostMessage_MouseClick(const std::function<int()> &GetNextId,
     m_Nodes.emplace_back(GetNextId(), "Win32 后台鼠标点击");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), PinType::Win32Handle, "窗口句柄");
     node.Inputs.emplace_back(GetNextId(), PinType::Point);
     node.Inputs.emplace_back(GetNextId(), PinType::Enum, "按键", EnumValue{MouseClickType, 0});
@@ -484,7 +489,7 @@ Node *Spawn_Win32_PostMessage_MouseClick(const std::function<int()> &GetNextId,
             delete simulator;
 
             // node->Outputs[0].Value = res != 0;
-            node->Outputs[1].Value = (int)GetLastError();
+            node->Outputs[1].SetValue((int)GetLastError());
         }
         catch_block_and_return;
     };
@@ -497,6 +502,7 @@ Node *Spawn_Win32_PostMessage_MouseMove(const std::function<int()> &GetNextId, c
     m_Nodes.emplace_back(GetNextId(), "Win32 后台鼠标移动");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), PinType::Win32Handle, "窗口句柄");
     node.Inputs.emplace_back(GetNextId(), PinType::Point);
     node.Inputs.emplace_back(GetNextId(), PinType::Bool, "是否相对坐标", false);
@@ -537,7 +543,7 @@ Node *Spawn_Win32_PostMessage_MouseMove(const std::function<int()> &GetNextId, c
             delete simulator;
 
             // node->Outputs[0].Value = res != 0;
-            node->Outputs[1].Value = (int)GetLastError();
+            node->Outputs[1].SetValue((int)GetLastError());
         }
         catch_block_and_return;
     };
@@ -550,6 +556,7 @@ Node *Spawn_Win32_PostMessage_MouseWheel(const std::function<int()> &GetNextId,
     m_Nodes.emplace_back(GetNextId(), "Win32 后台鼠标滚轮");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), PinType::Win32Handle, "窗口句柄");
     node.Inputs.emplace_back(GetNextId(), PinType::Int, "滚动值");
     node.Inputs.emplace_back(GetNextId(), PinType::Int, "等待毫秒", 0);
@@ -590,7 +597,7 @@ Node *Spawn_Win32_PostMessage_MouseWheel(const std::function<int()> &GetNextId,
             delete simulator;
 
             // node->Outputs[0].Value = res != 0;
-            node->Outputs[1].Value = (int)GetLastError();
+            node->Outputs[1].SetValue((int)GetLastError());
         }
         catch_block_and_return;
     };
@@ -603,6 +610,7 @@ Node *Spawn_Win32_PostMessage_KeyClick(const std::function<int()> &GetNextId, co
     m_Nodes.emplace_back(GetNextId(), "Win32 后台键盘点击");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
     node.Inputs.emplace_back(GetNextId(), PinType::Win32Handle, "窗口句柄");
     node.Inputs.emplace_back(GetNextId(), PinType::String, "按键", std::string("A"));
     node.Inputs.emplace_back(GetNextId(), PinType::Enum, "动作", EnumValue{KeyClickActionType, 0});
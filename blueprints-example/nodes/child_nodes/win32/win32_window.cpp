@@ -9,6 +9,7 @@ Node *Spawn_Win32_Window(const std::function<int()> &GetNextId, const std::funct
     m_Nodes.emplace_back(GetNextId(), "Win32 窗口句柄");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
 
     node.Inputs.emplace_back(GetNextId(), "窗口名称", PinType::String, std::string());
     node.Inputs.emplace_back(GetNextId(), "窗口类名", PinType::String, std::string());
@@ -47,9 +48,9 @@ Node *Spawn_Win32_Window(const std::function<int()> &GetNextId, const std::funct
             cv::Point point = {rect.left, rect.top};
             cv::Size size = {rect.right - rect.left, rect.bottom - rect.top};
 
-            node->Outputs[0].Value = handle;
-            node->Outputs[1].Value = size;
-            node->Outputs[2].Value = point;
+            node->Outputs[0].SetValue(handle);
+            node->Outputs[1].SetValue(size);
+            node->Outputs[2].SetValue(point);
         }
         catch_block_and_return;
     };
@@ -135,10 +136,10 @@ Node *Spawn_Win32_EnumWindow(const std::function<int()> &GetNextId, const std::f
             cv::Point point = {rect.left, rect.top};
             cv::Size size = {rect.right - rect.left, rect.bottom - rect.top};
 
-            node->Outputs[0].Value = (int)filtered_handles.size();
-            node->Outputs[1].Value = handle;
-            node->Outputs[2].Value = size;
-            node->Outputs[3].Value = point;
+            node->Outputs[0].SetValue((int)filtered_handles.size());
+            node->Outputs[1].SetValue(handle);
+            node->Outputs[2].SetValue(size);
+            node->Outputs[3].SetValue(point);
         }
         catch_block_and_return;
     };
@@ -154,6 +155,7 @@ Node *Spawn_Win32_MoveWindow(const std::function<int()> &GetNextId, const std::f
     m_Nodes.emplace_back(GetNextId(), "Win32 移动窗口");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
 
     node.Inputs.emplace_back(GetNextId(), "窗口句柄", PinType::Win32Handle, nullptr);
     node.Inputs.emplace_back(GetNextId(), "窗口位置", PinType::Point, cv::Point(0, 0));
@@ -183,8 +185,8 @@ Node *Spawn_Win32_MoveWindow(const std::function<int()> &GetNextId, const std::f
             GetWindowRect(handle, &rect);
             cv::Point new_point = {rect.left, rect.top};
 
-            node->Outputs[0].Value = handle;
-            node->Outputs[1].Value = new_point;
+            node->Outputs[0].SetValue(handle);
+            node->Outputs[1].SetValue(new_point);
         }
         catch_block_and_return;
     };
@@ -200,6 +202,7 @@ Node *Spawn_Win32_ResizeWindow(const std::function<int()> &GetNextId, const std:
     m_Nodes.emplace_back(GetNextId(), "Win32 调整窗口大小");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
 
     node.Inputs.emplace_back(GetNextId(), "窗口句柄", PinType::Win32Handle, nullptr);
     node.Inputs.emplace_back(GetNextId(), "窗口大小", PinType::Size, cv::Size(0, 0));
@@ -229,8 +232,8 @@ Node *Spawn_Win32_ResizeWindow(const std::function<int()> &GetNextId, const std:
             GetWindowRect(handle, &rect);
             cv::Size new_size = {rect.right - rect.left, rect.bottom - rect.top};
 
-            node->Outputs[0].Value = handle;
-            node->Outputs[1].Value = new_size;
+            node->Outputs[0].SetValue(handle);
+            node->Outputs[1].SetValue(new_size);
         }
         catch_block_and_return;
     };
@@ -246,6 +249,7 @@ Node *Spawn_Win32_ToggleWindow(const std::function<int()> &GetNextId, const std:
     m_Nodes.emplace_back(GetNextId(), "Win32 切换窗口");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
 
     node.Inputs.emplace_back(GetNextId(), "窗口句柄", PinType::Win32Handle, nullptr);
     node.Inputs.emplace_back(GetNextId(), "是否显示", PinType::Bool, true);
@@ -271,8 +275,8 @@ Node *Spawn_Win32_ToggleWindow(const std::function<int()> &GetNextId, const std:
 
             ShowWindow(handle, is_show ? SW_SHOW : SW_HIDE);
 
-            node->Outputs[0].Value = handle;
-            node->Outputs[1].Value = is_show;
+            node->Outputs[0].SetValue(handle);
+            node->Outputs[1].SetValue(is_show);
         }
         catch_block_and_return;
     };
@@ -288,6 +292,7 @@ Node *Spawn_Win32_CloseWindow(const std::function<int()> &GetNextId, const std::
     m_Nodes.emplace_back(GetNextId(), "Win32 关闭窗口");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
 
     node.Inputs.emplace_back(GetNextId(), "窗口句柄", PinType::Win32Handle, nullptr);
 
@@ -306,7 +311,7 @@ Node *Spawn_Win32_CloseWindow(const std::function<int()> &GetNextId, const std::
 
             SendMessage(handle, WM_CLOSE, 0, 0);
 
-            node->Outputs[0].Value = handle;
+            node->Outputs[0].SetValue(handle);
         }
         catch_block_and_return;
     };
@@ -322,6 +327,7 @@ Node *Spawn_Win32_GetWindowText(const std::function<int()> &GetNextId, const std
     m_Nodes.emplace_back(GetNextId(), "Win32 获取窗口文本");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
 
     node.Inputs.emplace_back(GetNextId(), "窗口句柄", PinType::Win32Handle, nullptr);
 
@@ -348,7 +354,7 @@ Node *Spawn_Win32_GetWindowText(const std::function<int()> &GetNextId, const std
             GetWindowTextW(handle, buffer.data(), length + 1);
 
             std::string text = utils::to_string(buffer.data());
-            node->Outputs[0].Value = text;
+            node->Outputs[0].SetValue(text);
         }
         catch_block_and_return;
     };
@@ -364,6 +370,7 @@ Node *Spawn_Win32_SetWindowText(const std::function<int()> &GetNextId, const std
     m_Nodes.emplace_back(GetNextId(), "Win32 设置窗口文本");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
 
     node.Inputs.emplace_back(GetNextId(), "窗口句柄", PinType::Win32Handle, nullptr);
     node.Inputs.emplace_back(GetNextId(), "窗口文本", PinType::String, std::string());
@@ -401,6 +408,7 @@ Node *Spawn_Win32_GetTopWindow(const std::function<int()> &GetNextId, const std:
     m_Nodes.emplace_back(GetNextId(), "Win32 获取顶层窗口");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
 
     node.Outputs.emplace_back(GetNextId(), "窗口句柄", PinType::Win32Handle);
 
@@ -415,7 +423,7 @@ Node *Spawn_Win32_GetTopWindow(const std::function<int()> &GetNextId, const std:
             if (handle == NULL)
                 return ExecuteResult::ErrorNode(node->ID, "未找到顶层窗口");
 
-            node->Outputs[0].Value = handle;
+            node->Outputs[0].SetValue(handle);
         }
         catch_block_and_return;
     };
@@ -431,6 +439,7 @@ Node *Spawn_Win32_GetWindowRect(const std::function<int()> &GetNextId, const std
     m_Nodes.emplace_back(GetNextId(), "Win32 获取窗口矩形");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
 
     node.Inputs.emplace_back(GetNextId(), "窗口句柄", PinType::Win32Handle, nullptr);
 
@@ -453,7 +462,7 @@ Node *Spawn_Win32_GetWindowRect(const std::function<int()> &GetNextId, const std
             GetWindowRect(handle, &rect);
 
             cv::Rect window_rect = {rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top};
-            node->Outputs[0].Value = window_rect;
+            node->Outputs[0].SetValue(window_rect);
         }
         catch_block_and_return;
     };
@@ -469,6 +478,7 @@ Node *Spawn_Win32_GetClientRect(const std::function<int()> &GetNextId, const std
     m_Nodes.emplace_back(GetNextId(), "Win32 获取客户区矩形");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
 
     node.Inputs.emplace_back(GetNextId(), "窗口句柄", PinType::Win32Handle, nullptr);
 
@@ -491,7 +501,7 @@ Node *Spawn_Win32_GetClientRect(const std::function<int()> &GetNextId, const std
             GetClientRect(handle, &rect);
 
             cv::Rect client_rect = {rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top};
-            node->Outputs[0].Value = client_rect;
+            node->Outputs[0].SetValue(client_rect);
         }
         catch_block_and_return;
     };
@@ -507,6 +517,7 @@ Node *Spawn_Win32_GetActiveWindow(const std::function<int()> &GetNextId, const s
     m_Nodes.emplace_back(GetNextId(), "Win32 获取活动窗口");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
 
     node.Outputs.emplace_back(GetNextId(), "窗口句柄", PinType::Win32Handle);
 
@@ -521,7 +532,7 @@ Node *Spawn_Win32_GetActiveWindow(const std::function<int()> &GetNextId, const s
             if (handle == NULL)
                 return ExecuteResult::ErrorNode(node->ID, "未找到活动窗口");
 
-            node->Outputs[0].Value = handle;
+            node->Outputs[0].SetValue(handle);
         }
         catch_block_and_return;
     };
@@ -537,6 +548,7 @@ Node *Spawn_Win32_SetActiveWindow(const std::function<int()> &GetNextId, const s
     m_Nodes.emplace_back(GetNextId(), "Win32 设置活动窗口");
     auto &node = m_Nodes.back();
     node.Type = NodeType::Win32;
+    node.AlwaysExecute = true;
 
     node.Inputs.emplace_back(GetNextId(), "窗口句柄", PinType::Win32Handle, nullptr);
 
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// 执行性能记录：环形缓冲区保存最近若干次执行中每个执行了的节点的耗时，供性能面板统计
+// 只记录在图上的执行，上下文和流式执行会和其他执行重叠，不计入
+class execution_profile
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct sample
+    {
+        uintptr_t node_id = 0;
+        std::string name;
+        std::string type;
+        // 执行节点的线程在本次执行中的序号，从 0 开始
+        size_t lane = 0;
+        // 相对于执行开始的毫秒数
+        double begin_ms = 0;
+        double end_ms = 0;
+        double queue_wait_ms = 0;
+    };
+
+    struct run
+    {
+        double total_ms = 0;
+        size_t lanes = 0;
+        std::vector<sample> samples;
+    };
+
+    struct node_stats
+    {
+        uintptr_t node_id = 0;
+        std::string name;
+        std::string type;
+        size_t count = 0;
+        double p50 = 0;
+        double p95 = 0;
+        double p99 = 0;
+        double mean = 0;
+        double total_ms = 0;
+    };
+
+    explicit execution_profile(size_t capacity = 64) : capacity(std::max<size_t>(capacity, 1)) {}
+
+    void begin_run()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current = run();
+        lanes.clear();
+        run_begin = clock::now();
+        recording = true;
+    }
+
+    void add(uintptr_t node_id, const std::string &name, const std::string &type, clock::time_point ready, clock::time_point begin, clock::time_point end)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!recording)
+            return;
+        sample s;
+        s.node_id = node_id;
+        s.name = name;
+        s.type = type;
+        s.lane = lanes.emplace(std::this_thread::get_id(), lanes.size()).first->second;
+        s.begin_ms = to_ms(begin - run_begin);
+        s.end_ms = to_ms(end - run_begin);
+        s.queue_wait_ms = to_ms(begin - ready);
+        current.samples.push_back(std::move(s));
+    }
+
+    void end_run()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!recording)
+            return;
+        recording = false;
+        current.total_ms = to_ms(clock::now() - run_begin);
+        current.lanes = lanes.size();
+        runs.push_back(std::move(current));
+        while (runs.size() > capacity)
+            runs.pop_front();
+    }
+
+    void set_capacity(size_t value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        capacity = std::max<size_t>(value, 1);
+        while (runs.size() > capacity)
+            runs.pop_front();
+    }
+
+    size_t get_capacity()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return capacity;
+    }
+
+    size_t get_run_count()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return runs.size();
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        runs.clear();
+    }
+
+    std::optional<run> latest()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (runs.empty())
+            return std::nullopt;
+        return runs.back();
+    }
+
+    // 每个节点在缓冲区内所有执行中的耗时分位数，按总耗时从大到小排序
+    std::vector<node_stats> get_node_stats()
+    {
+        std::unordered_map<uintptr_t, std::vector<double>> durations;
+        std::unordered_map<uintptr_t, node_stats> stats;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &r : runs)
+                for (auto &s : r.samples)
+                {
+                    durations[s.node_id].push_back(s.end_ms - s.begin_ms);
+                    auto &stat = stats[s.node_id];
+                    stat.node_id = s.node_id;
+                    stat.name = s.name;
+                    stat.type = s.type;
+                }
+        }
+        std::vector<node_stats> result;
+        for (auto &[id, values] : durations)
+        {
+            auto &stat = stats[id];
+            std::sort(values.begin(), values.end());
+            stat.count = values.size();
+            for (auto ms : values)
+                stat.total_ms += ms;
+            stat.mean = stat.total_ms / values.size();
+            stat.p50 = percentile(values, 0.50);
+            stat.p95 = percentile(values, 0.95);
+            stat.p99 = percentile(values, 0.99);
+            result.push_back(std::move(stat));
+        }
+        std::sort(result.begin(), result.end(), [](const node_stats &a, const node_stats &b)
+                  { return a.total_ms > b.total_ms; });
+        return result;
+    }
+
+    // 节点在缓冲区内每次执行的耗时，按执行的先后顺序
+    std::vector<double> get_node_durations(uintptr_t node_id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<double> result;
+        for (auto &r : runs)
+            for (auto &s : r.samples)
+                if (s.node_id == node_id)
+                    result.push_back(s.end_ms - s.begin_ms);
+        return result;
+    }
+
+    // 每种节点类型的总耗时占所有节点总耗时的比例，从大到小排序
+    std::vector<std::pair<std::string, double>> get_type_shares()
+    {
+        std::map<std::string, double> totals;
+        double sum = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto &r : runs)
+                for (auto &s : r.samples)
+                {
+                    totals[s.type] += s.end_ms - s.begin_ms;
+                    sum += s.end_ms - s.begin_ms;
+                }
+        }
+        std::vector<std::pair<std::string, double>> result(totals.begin(), totals.end());
+        for (auto &item : result)
+            item.second = sum > 0 ? item.second / sum : 0;
+        std::sort(result.begin(), result.end(), [](const auto &a, const auto &b)
+                  { return a.second > b.second; });
+        return result;
+    }
+
+    // 最近秩法，sorted 从小到大排序
+    static double percentile(const std::vector<double> &sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+        auto rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+private:
+    static double to_ms(clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    std::mutex mutex;
+    size_t capacity;
+    std::deque<run> runs;
+    run current;
+    clock::time_point run_begin;
+    std::unordered_map<std::thread::id, size_t> lanes;
+    bool recording = false;
+};
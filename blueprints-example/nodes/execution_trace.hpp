@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <json.hpp>
+
+// 执行轨迹：按 Chrome trace event 格式记录执行过程，导出的文件可以在 Perfetto 或 chrome://tracing 中打开
+// 每个执行节点的线程一条轨道，节点执行是完整事件，排队等待是异步事件，调度器的动作是瞬时事件，内存是计数器
+class execution_trace
+{
+public:
+    using clock = std::chrono::steady_clock;
+    using args_t = std::vector<std::pair<std::string, json::value>>;
+
+    // 超过后丢弃新的事件，避免一直开着记录时内存无限增长
+    static constexpr size_t max_events = 1000000;
+
+    execution_trace() : origin(clock::now()) {}
+
+    // 节点在某个线程上从 begin 执行到 end
+    void complete(const std::string &name, const std::string &category, clock::time_point begin, clock::time_point end, args_t args = {})
+    {
+        event e;
+        e.phase = 'X';
+        e.name = name;
+        e.category = category;
+        e.time = begin;
+        e.duration = std::max(end - begin, clock::duration::zero());
+        e.args = std::move(args);
+        add(std::move(e));
+    }
+
+    // 异步事件不属于某个线程，id 相同的开始和结束配对，用于记录节点在就绪队列中的等待
+    void async_begin(const std::string &name, const std::string &category, uint64_t id, clock::time_point time)
+    {
+        add_async('b', name, category, id, time);
+    }
+
+    void async_end(const std::string &name, const std::string &category, uint64_t id, clock::time_point time)
+    {
+        add_async('e', name, category, id, time);
+    }
+
+    void instant(const std::string &name, const std::string &category, clock::time_point time, args_t args = {})
+    {
+        event e;
+        e.phase = 'i';
+        e.name = name;
+        e.category = category;
+        e.time = time;
+        e.args = std::move(args);
+        add(std::move(e));
+    }
+
+    void counter(const std::string &name, clock::time_point time, double value)
+    {
+        event e;
+        e.phase = 'C';
+        e.name = name;
+        e.time = time;
+        e.args.emplace_back("value", value);
+        add(std::move(e));
+    }
+
+    // 为当前线程的轨道命名，没有命名的线程按首次出现的顺序编号
+    void name_current_thread(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        thread_names[current_track()] = name;
+    }
+
+    // 新的执行编号，异步事件的 id 由执行编号和节点下标组成，不同执行之间不会冲突
+    uint64_t next_run()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return ++run_counter;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.clear();
+        dropped = 0;
+        origin = clock::now();
+    }
+
+    size_t size()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return events.size();
+    }
+
+    size_t get_dropped()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return dropped;
+    }
+
+    json::object to_json()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        json::array trace_events;
+        trace_events.push_back(json::object{{"ph", "M"}, {"name", "process_name"}, {"pid", 1}, {"tid", 0}, {"args", json::object{{"name", "image-node-editor"}}}});
+        for (auto &[id, track] : tracks)
+        {
+            auto it = thread_names.find(track);
+            auto name = it != thread_names.end() ? it->second : "工作线程 " + std::to_string(track);
+            trace_events.push_back(json::object{{"ph", "M"}, {"name", "thread_name"}, {"pid", 1}, {"tid", track}, {"args", json::object{{"name", name}}}});
+            trace_events.push_back(json::object{{"ph", "M"}, {"name", "thread_sort_index"}, {"pid", 1}, {"tid", track}, {"args", json::object{{"sort_index", track}}}});
+        }
+        for (auto &e : events)
+        {
+            json::object obj;
+            obj["ph"] = std::string(1, e.phase);
+            obj["name"] = e.name;
+            if (!e.category.empty())
+                obj["cat"] = e.category;
+            obj["ts"] = to_us(e.time);
+            obj["pid"] = 1;
+            obj["tid"] = e.tid;
+            if (e.phase == 'X')
+                obj["dur"] = std::chrono::duration_cast<std::chrono::microseconds>(e.duration).count();
+            if (e.phase == 'b' || e.phase == 'e')
+                obj["id"] = std::to_string(e.id);
+            if (e.phase == 'i')
+                obj["s"] = "t";
+            if (!e.args.empty())
+            {
+                json::object args;
+                for (auto &[key, value] : e.args)
+                    args[key] = value;
+                obj["args"] = args;
+            }
+            trace_events.push_back(obj);
+        }
+        json::object root;
+        root["traceEvents"] = trace_events;
+        root["displayTimeUnit"] = "ms";
+        return root;
+    }
+
+    bool write(const std::string &path)
+    {
+        std::ofstream out(path, std::ios::binary);
+        if (!out)
+            return false;
+        out << to_json().dumps();
+        return out.good();
+    }
+
+private:
+    struct event
+    {
+        // X 完整事件，b/e 异步事件的开始和结束，i 瞬时事件，C 计数器
+        char phase = 'X';
+        std::string name;
+        std::string category;
+        clock::time_point time;
+        clock::duration duration{};
+        uint32_t tid = 0;
+        uint64_t id = 0;
+        args_t args;
+    };
+
+    void add_async(char phase, const std::string &name, const std::string &category, uint64_t id, clock::time_point time)
+    {
+        event e;
+        e.phase = phase;
+        e.name = name;
+        e.category = category;
+        e.id = id;
+        e.time = time;
+        add(std::move(e));
+    }
+
+    void add(event e)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (events.size() >= max_events)
+        {
+            dropped++;
+            return;
+        }
+        e.tid = current_track();
+        events.push_back(std::move(e));
+    }
+
+    // 以下函数调用时需要持有锁
+
+    // 导出时转换为相对于轨迹开始的微秒数
+    int64_t to_us(clock::time_point time) const
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time - origin).count();
+    }
+
+    uint32_t current_track()
+    {
+        auto id = std::this_thread::get_id();
+        auto it = tracks.find(id);
+        if (it != tracks.end())
+            return it->second;
+        auto track = static_cast<uint32_t>(tracks.size() + 1);
+        tracks.emplace(id, track);
+        return track;
+    }
+
+    std::mutex mutex;
+    clock::time_point origin;
+    std::vector<event> events;
+    std::unordered_map<std::thread::id, uint32_t> tracks;
+    std::unordered_map<uint32_t, std::string> thread_names;
+    uint64_t run_counter = 0;
+    size_t dropped = 0;
+};
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+// 固定频率循环调度器
+// 在独立线程中按目标频率产生节拍，每个节拍请求执行一次，和界面的刷新频率无关
+// 上一次执行还没有结束时，按策略处理新的节拍：
+//   忙时跳过：丢弃这个节拍
+//   丢弃旧的：取消正在进行的执行，结束后立即按最新的节拍执行
+//   排队：最多排队 N 个节拍，执行结束后立即执行排队的节拍，超出的丢弃
+class loop_scheduler
+{
+public:
+    enum class policy
+    {
+        skip_if_busy,
+        drop_oldest,
+        queue,
+    };
+
+    struct callbacks_t
+    {
+        // 尝试开始一次执行，已经在执行时返回空
+        std::function<std::optional<std::future<void>>()> try_start;
+        // 取消正在进行的执行
+        std::function<void()> cancel;
+    };
+
+    struct stats_t
+    {
+        size_t ticks = 0;
+        size_t runs = 0;
+        // 因为忙而丢弃的节拍
+        size_t skipped = 0;
+        // 因为新的节拍而被取消的执行
+        size_t cancelled = 0;
+        // 没有在下一个节拍之前完成的执行
+        size_t missed_deadlines = 0;
+        // 抛出异常的执行，也计入 runs
+        size_t failed_runs = 0;
+        // 节拍实际唤醒时间和计划时间的偏差
+        double jitter_mean_ms = 0;
+        double jitter_max_ms = 0;
+        // 从节拍到执行完成的耗时
+        double last_latency_ms = 0;
+        // 实际执行频率
+        double rate_hz = 0;
+    };
+
+    ~loop_scheduler()
+    {
+        stop();
+    }
+
+    void start(double rate_hz, policy run_policy, size_t queue_limit, callbacks_t callbacks)
+    {
+        stop();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats = stats_t();
+            jitter_sum_ms = 0;
+            stopping = false;
+        }
+        period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / std::max(rate_hz, 0.1)));
+        this->run_policy = run_policy;
+        this->queue_limit = std::max<size_t>(queue_limit, 1);
+        this->callbacks = std::move(callbacks);
+        running = true;
+        thread = std::thread([this]()
+                             { loop(); });
+    }
+
+    // 等待正在进行的执行结束后返回
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+        if (thread.joinable())
+            thread.join();
+        running = false;
+    }
+
+    bool is_running() const
+    {
+        return running;
+    }
+
+    stats_t get_stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats;
+    }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct run_t
+    {
+        std::future<void> future;
+        // 对应节拍的计划时间
+        clock::time_point tick;
+    };
+
+    static double to_ms(clock::duration duration)
+    {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    bool is_stopping()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stopping;
+    }
+
+    bool try_start(clock::time_point tick)
+    {
+        auto future = callbacks.try_start();
+        if (!future)
+            return false;
+        current = run_t{std::move(*future), tick};
+        return true;
+    }
+
+    void finish_current(clock::time_point begin)
+    {
+        // 执行中的异常不能在循环线程中抛出，记录后继续按节拍执行
+        bool failed = false;
+        try
+        {
+            current->future.get();
+        }
+        catch (...)
+        {
+            failed = true;
+        }
+        auto now = clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.runs++;
+        if (failed)
+            stats.failed_runs++;
+        stats.last_latency_ms = to_ms(now - current->tick);
+        if (now > current->tick + period)
+            stats.missed_deadlines++;
+        auto seconds = std::chrono::duration<double>(now - begin).count();
+        stats.rate_hz = seconds > 0 ? stats.runs / seconds : 0.0;
+        current.reset();
+    }
+
+    void wait_until(clock::time_point time)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_until(lock, time, [this]()
+                      { return stopping; });
+    }
+
+    void loop()
+    {
+        const auto begin = clock::now();
+        auto next_tick = begin;
+        size_t pending = 0;
+        while (!is_stopping())
+        {
+            // 等待下一个节拍，期间执行结束时立即开始排队的节拍
+            while (!is_stopping() && clock::now() < next_tick)
+            {
+                // 执行结束时不会通知条件变量，分段等待，stop() 最多等待一个分段就能让循环退出
+                if (current && current->future.wait_until(std::min(next_tick, clock::now() + stop_poll_interval)) == std::future_status::ready)
+                {
+                    finish_current(begin);
+                    if (pending > 0 && try_start(next_tick - period))
+                        pending--;
+                }
+                else if (!current)
+                {
+                    wait_until(next_tick);
+                }
+            }
+            if (is_stopping())
+                break;
+
+            auto now = clock::now();
+            bool busy = current && current->future.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+            if (current && !busy)
+                finish_current(begin);
+            size_t skipped = 0;
+            size_t cancelled = 0;
+            if (busy || !try_start(next_tick))
+            {
+                switch (run_policy)
+                {
+                case policy::skip_if_busy:
+                    skipped++;
+                    break;
+                case policy::drop_oldest:
+                    if (current)
+                    {
+                        callbacks.cancel();
+                        cancelled++;
+                    }
+                    pending = 1;
+                    break;
+                case policy::queue:
+                    if (pending < queue_limit)
+                        pending++;
+                    else
+                        skipped++;
+                    break;
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto jitter_ms = to_ms(now - next_tick);
+                stats.ticks++;
+                stats.skipped += skipped;
+                stats.cancelled += cancelled;
+                jitter_sum_ms += jitter_ms;
+                stats.jitter_mean_ms = jitter_sum_ms / stats.ticks;
+                stats.jitter_max_ms = std::max(stats.jitter_max_ms, jitter_ms);
+            }
+
+            // 线程本身被延迟超过一个周期时重新对齐，不补发错过的节拍
+            next_tick += period;
+            if (next_tick < now)
+                next_tick = now + period;
+        }
+        if (current)
+            current->future.wait();
+        current.reset();
+    }
+
+    static constexpr std::chrono::milliseconds stop_poll_interval{5};
+
+    callbacks_t callbacks;
+    clock::duration period = std::chrono::milliseconds(33);
+    policy run_policy = policy::skip_if_busy;
+    size_t queue_limit = 1;
+
+    std::optional<run_t> current;
+    double jitter_sum_ms = 0;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+    stats_t stats;
+
+    std::atomic<bool> running = false;
+    std::thread thread;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+#include <opencv2/core.hpp>
+
+// 统计 cv::Mat 分配图像内存的次数
+// 包装 OpenCV 的默认分配器，只计数不改变分配方式；计数覆盖整个进程，界面线程的分配也会计入
+class mat_allocation_counter : public cv::MatAllocator
+{
+public:
+    static mat_allocation_counter &instance()
+    {
+        static mat_allocation_counter counter;
+        return counter;
+    }
+
+    // 设置为默认分配器，只在第一次调用时生效
+    static void install()
+    {
+        static std::once_flag once;
+        std::call_once(once, []()
+                       {
+            auto &counter = instance();
+            counter.underlying = cv::Mat::getDefaultAllocator();
+            cv::Mat::setDefaultAllocator(&counter); });
+    }
+
+    size_t get_count() const
+    {
+        return count;
+    }
+
+    cv::UMatData *allocate(int dims, const int *sizes, int type, void *data, size_t *step, cv::AccessFlag flags, cv::UMatUsageFlags usage_flags) const override
+    {
+        // 外部数据不分配内存
+        if (!data)
+            count++;
+        return underlying->allocate(dims, sizes, type, data, step, flags, usage_flags);
+    }
+
+    bool allocate(cv::UMatData *data, cv::AccessFlag access_flags, cv::UMatUsageFlags usage_flags) const override
+    {
+        return underlying->allocate(data, access_flags, usage_flags);
+    }
+
+    // 分配出的 UMatData 记录的是底层分配器，释放不会经过这里
+    void deallocate(cv::UMatData *data) const override
+    {
+        underlying->deallocate(data);
+    }
+
+private:
+    mat_allocation_counter() = default;
+
+    cv::MatAllocator *underlying = cv::Mat::getStdAllocator();
+    mutable std::atomic<size_t> count = 0;
+};
@@ -0,0 +1,413 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "node_port_types.hpp"
+#include "base_nodes.hpp"
+
+// 把节点图导出为独立的 C++17 程序
+// 每个节点的 ast.code 是一段代码模板，$n 对应 ast.add_params 的第 n 个参数：
+//   前 Inputs.size() 个参数是输入端口，有连线时替换为上游输出的变量，否则替换为提升到文件作用域的常量
+//   接下来 Outputs.size() 个参数是输出端口，替换为 pipeline 的成员变量，多次运行之间复用缓冲区
+//   其余参数是节点内部的临时变量，由模板自己声明
+// 模板给输出端口赋值而不是声明它们，失败时 return false
+class node_code_generator
+{
+public:
+    // 生成的程序源码和对应的 CMakeLists.txt
+    std::string source;
+    std::string cmake;
+
+    ExecuteResult generate(Graph *graph)
+    {
+        source.clear();
+        cmake.clear();
+        constants.clear();
+        members.clear();
+        body.clear();
+        output_names.clear();
+
+        auto plan = graph->env.get_plan();
+        if (plan->order.size() != plan->nodes.size())
+        {
+            for (size_t i = 0; i < plan->nodes.size(); i++)
+                if (std::find(plan->order.begin(), plan->order.end(), i) == plan->order.end())
+                    return ExecuteResult::ErrorNode(plan->nodes[i]->ID, "节点在环上，无法导出");
+        }
+
+        // 节点的全局定义按名称去重
+        std::map<std::string, std::string> global_defines;
+        for (auto index : plan->order)
+        {
+            auto node = plan->nodes[index];
+            if (node->Type == NodeType::Comment)
+                continue;
+            if (node->ast.code.empty())
+                return ExecuteResult::ErrorNode(node->ID, "节点 " + node->Name + " 没有代码模板，无法导出");
+            if (!node->ast.global_define.empty())
+                global_defines.insert({node->Name, node->ast.global_define});
+            if (auto result = emit_node(*plan, index); result.has_error())
+                return result;
+        }
+
+        source += "// 由 image-node-editor 导出\n";
+        source += "#include <opencv2/opencv.hpp>\n";
+        source += "#include <algorithm>\n";
+        source += "#include <chrono>\n";
+        source += "#include <cstdio>\n";
+        source += "#include <cstdlib>\n";
+        source += "#include <fstream>\n";
+        source += "#include <string>\n";
+        source += "#include <vector>\n";
+        for (auto &[_, define] : global_defines)
+            source += define + "\n";
+        source += "\n";
+        source += constants;
+        source += "\nstruct pipeline\n{\n";
+        source += members;
+        source += "\n    bool run()\n    {\n";
+        source += body;
+        source += "        return true;\n    }\n};\n\n";
+        source += harness_source;
+
+        cmake = cmake_source;
+        return ExecuteResult::Success();
+    }
+
+    // 生成的代码写入目录中的 pipeline.cpp 和 CMakeLists.txt
+    ExecuteResult write(const std::string &output_dir)
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(output_dir, ec);
+        if (ec)
+            return ExecuteResult::ErrorNode(ed::NodeId(), "无法创建目录 " + output_dir + ": " + ec.message());
+        auto dir = std::filesystem::path(output_dir);
+        for (auto &[name, content] : {std::pair{"pipeline.cpp", &source}, std::pair{"CMakeLists.txt", &cmake}})
+        {
+            std::ofstream file(dir / name, std::ios::binary);
+            if (!file.is_open())
+                return ExecuteResult::ErrorNode(ed::NodeId(), "无法写入文件 " + (dir / name).string());
+            file << *content;
+        }
+        return ExecuteResult::Success();
+    }
+
+    // 端口类型对应的 C++ 类型，不支持导出的类型返回空
+    static std::string type_name(PinType type)
+    {
+        switch (type)
+        {
+        case PinType::Int:
+            return "int";
+        case PinType::Float:
+            return "float";
+        case PinType::Bool:
+            return "bool";
+        case PinType::String:
+            return "std::string";
+        case PinType::Image:
+            return "cv::Mat";
+        case PinType::Rect:
+            return "cv::Rect";
+        case PinType::Size:
+            return "cv::Size";
+        case PinType::Point:
+            return "cv::Point";
+        case PinType::Color:
+            return "cv::Scalar";
+        case PinType::Contour:
+            return "std::vector<cv::Point>";
+        case PinType::Contours:
+            return "std::vector<std::vector<cv::Point>>";
+        case PinType::KeyPoint:
+            return "cv::KeyPoint";
+        case PinType::KeyPoints:
+            return "std::vector<cv::KeyPoint>";
+        case PinType::Feature:
+            return "std::pair<std::vector<cv::KeyPoint>, cv::Mat>";
+        case PinType::Match:
+            return "cv::DMatch";
+        case PinType::Matches:
+            return "std::vector<cv::DMatch>";
+        case PinType::Circles:
+            return "std::vector<cv::Vec3f>";
+        default:
+            return std::string();
+        }
+    }
+
+    // 常量的初始化表达式，没有字面量形式的类型返回空，使用默认值
+    static std::string literal(const port_value_t &value)
+    {
+        if (std::holds_alternative<int>(value))
+            return std::to_string(std::get<int>(value));
+        if (std::holds_alternative<float>(value))
+            return float_literal(std::get<float>(value));
+        if (std::holds_alternative<bool>(value))
+            return std::get<bool>(value) ? "true" : "false";
+        if (std::holds_alternative<std::string>(value))
+            return string_literal(std::get<std::string>(value));
+        if (std::holds_alternative<cv::Rect>(value))
+        {
+            auto &rect = std::get<cv::Rect>(value);
+            return "cv::Rect(" + std::to_string(rect.x) + ", " + std::to_string(rect.y) + ", " + std::to_string(rect.width) + ", " + std::to_string(rect.height) + ")";
+        }
+        if (std::holds_alternative<cv::Size>(value))
+        {
+            auto &size = std::get<cv::Size>(value);
+            return "cv::Size(" + std::to_string(size.width) + ", " + std::to_string(size.height) + ")";
+        }
+        if (std::holds_alternative<cv::Point>(value))
+        {
+            auto &point = std::get<cv::Point>(value);
+            return "cv::Point(" + std::to_string(point.x) + ", " + std::to_string(point.y) + ")";
+        }
+        if (std::holds_alternative<cv::Scalar>(value))
+        {
+            auto &color = std::get<cv::Scalar>(value);
+            std::string text = "cv::Scalar(";
+            for (int i = 0; i < 4; i++)
+                text += (i ? ", " : "") + double_literal(color[i]);
+            return text + ")";
+        }
+        return std::string();
+    }
+
+private:
+    // 变量名中只保留字母、数字和下划线
+    static std::string identifier(const std::string &name)
+    {
+        std::string result;
+        for (auto c : name)
+            result += (std::isalnum(static_cast<unsigned char>(c)) && static_cast<unsigned char>(c) < 0x80) ? c : '_';
+        if (result.empty() || std::isdigit(static_cast<unsigned char>(result[0])))
+            result = "v_" + result;
+        return result;
+    }
+
+    static std::string id_of(uintptr_t id)
+    {
+        return std::to_string(static_cast<unsigned long long>(id));
+    }
+
+    static std::string double_literal(double value)
+    {
+        if (!std::isfinite(value))
+            return "0.0";
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+        std::string text = buffer;
+        if (text.find_first_of(".e") == std::string::npos)
+            text += ".0";
+        return text;
+    }
+
+    static std::string float_literal(float value)
+    {
+        if (!std::isfinite(value))
+            return "0.0f";
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+        std::string text = buffer;
+        if (text.find_first_of(".e") == std::string::npos)
+            text += ".0";
+        return text + "f";
+    }
+
+    // 不可打印字符用八进制转义，UTF-8 字节原样保留
+    static std::string string_literal(const std::string &value)
+    {
+        std::string text = "\"";
+        for (auto c : value)
+        {
+            auto byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\')
+                text += std::string("\\") + c;
+            else if (byte < 0x20 || byte == 0x7f)
+            {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\%03o", byte);
+                text += buffer;
+            }
+            else
+                text += c;
+        }
+        return text + "\"";
+    }
+
+    // 节点注释中去掉换行
+    static std::string comment(const Node *node)
+    {
+        std::string name = node->Name;
+        std::replace(name.begin(), name.end(), '\n', ' ');
+        return name + " #" + id_of(node->ID.Get());
+    }
+
+    ExecuteResult emit_node(const execution_plan &plan, size_t index)
+    {
+        auto node = plan.nodes[index];
+        auto &ast = node->ast;
+        std::map<int, std::string> names;
+        for (auto &[param, id_str] : ast.param_ids)
+        {
+            auto param_name = identifier(ast.params.at(id_str));
+            size_t pin = static_cast<size_t>(param);
+            if (pin < node->Inputs.size())
+            {
+                auto &input = node->Inputs[pin];
+                if (auto source = plan.source_pin(index, pin))
+                {
+                    auto it = output_names.find(source->ID.Get());
+                    if (it == output_names.end())
+                        return ExecuteResult::ErrorPin(input.ID, "上游节点没有导出这个输出");
+                    names[param] = it->second;
+                    continue;
+                }
+                auto type = type_name(input.Type);
+                if (type.empty())
+                    return ExecuteResult::ErrorPin(input.ID, "端口类型不支持导出");
+                // 没有连线的输入是常量，提升到文件作用域，只初始化一次
+                auto name = "k_" + param_name + "_" + id_of(input.ID.Get());
+                auto value = literal(*input.Value);
+                constants += "// " + comment(node) + " " + input.Name + "\n";
+                constants += "static const " + type + " " + name + (value.empty() ? "" : " = " + value) + ";\n";
+                names[param] = name;
+                continue;
+            }
+            pin -= node->Inputs.size();
+            if (pin < node->Outputs.size())
+            {
+                auto &output = node->Outputs[pin];
+                auto type = type_name(output.Type);
+                if (type.empty())
+                    return ExecuteResult::ErrorPin(output.ID, "端口类型不支持导出");
+                auto name = param_name + "_" + id_of(output.ID.Get());
+                members += "    " + type + " " + name + ";\n";
+                output_names[output.ID.Get()] = name;
+                names[param] = name;
+                continue;
+            }
+            names[param] = param_name + "_n" + id_of(node->ID.Get());
+        }
+
+        // 替换 $n，按完整的数字匹配，$1 不会匹配 $10 的前缀
+        std::string code;
+        auto &text = ast.code;
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            if (text[i] != '$' || i + 1 >= text.size() || !std::isdigit(static_cast<unsigned char>(text[i + 1])))
+            {
+                code += text[i];
+                continue;
+            }
+            size_t end = i + 1;
+            while (end < text.size() && std::isdigit(static_cast<unsigned char>(text[end])))
+                end++;
+            int param = std::stoi(text.substr(i + 1, end - i - 1));
+            auto it = names.find(param);
+            if (it == names.end())
+                return ExecuteResult::ErrorNode(node->ID, "代码模板引用了未定义的参数 $" + std::to_string(param));
+            code += it->second;
+            i = end - 1;
+        }
+
+        body += "        // " + comment(node) + "\n";
+        body += "        {\n";
+        // 模板中的语句写在同一行，按分号拆分成多行
+        std::string line;
+        int depth = 0;
+        bool in_string = false;
+        for (size_t i = 0; i < code.size(); i++)
+        {
+            char c = code[i];
+            line += c;
+            if (c == '"' && (i == 0 || code[i - 1] != '\\'))
+                in_string = !in_string;
+            if (in_string)
+                continue;
+            if (c == '(' || c == '[')
+                depth++;
+            else if (c == ')' || c == ']')
+                depth--;
+            else if (c == ';' && depth == 0)
+            {
+                auto first = line.find_first_not_of(' ');
+                body += "            " + line.substr(first) + "\n";
+                line.clear();
+            }
+        }
+        if (line.find_first_not_of(' ') != std::string::npos)
+            body += "            " + line.substr(line.find_first_not_of(' ')) + "\n";
+        body += "        }\n";
+        return ExecuteResult::Success();
+    }
+
+    std::string constants;
+    std::string members;
+    std::string body;
+    // 已导出的输出端口对应的变量名
+    std::map<uintptr_t, std::string> output_names;
+
+    // 计时：先运行一次预热，然后运行指定次数，输出每次运行耗时的统计
+    static constexpr const char *harness_source = R"(int main(int argc, char **argv)
+{
+    int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1;
+    pipeline p;
+    if (!p.run())
+    {
+        std::fprintf(stderr, "pipeline failed\n");
+        return 1;
+    }
+
+    std::vector<double> times;
+    times.reserve(iterations);
+    for (int i = 0; i < iterations; i++)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        bool ok = p.run();
+        auto end = std::chrono::steady_clock::now();
+        if (!ok)
+        {
+            std::fprintf(stderr, "pipeline failed at iteration %d\n", i);
+            return 1;
+        }
+        times.push_back(std::chrono::duration<double, std::milli>(end - begin).count());
+    }
+    std::sort(times.begin(), times.end());
+    double sum = 0;
+    for (auto t : times)
+        sum += t;
+    std::printf("iterations: %d\n", iterations);
+    std::printf("mean: %.3f ms\n", sum / times.size());
+    std::printf("min: %.3f ms  p50: %.3f ms  p95: %.3f ms  max: %.3f ms\n",
+                times.front(), times[times.size() / 2], times[std::min(times.size() - 1, times.size() * 95 / 100)], times.back());
+    return 0;
+}
+)";
+
+    static constexpr const char *cmake_source = R"(cmake_minimum_required(VERSION 3.10)
+project(pipeline CXX)
+
+set(CMAKE_CXX_STANDARD 17)
+set(CMAKE_CXX_STANDARD_REQUIRED ON)
+if (NOT CMAKE_BUILD_TYPE)
+    set(CMAKE_BUILD_TYPE Release)
+endif()
+
+find_package(OpenCV REQUIRED)
+
+add_executable(pipeline pipeline.cpp)
+target_link_libraries(pipeline PRIVATE ${OpenCV_LIBS})
+if (MSVC)
+    target_compile_options(pipeline PRIVATE /utf-8)
+endif()
+)";
+};
@@ -13,8 +13,15 @@
 #include <optional>
 #include <atomic>
 #include <future>
+#include <memory>
 
+// 命令行工具不引入 Windows 头文件，窗口句柄只作为不透明的端口值，和 Windows.h 中的声明相同
+#ifndef IMAGE_NODE_HEADLESS
 #include <Windows.h>
+#else
+struct HWND__;
+typedef HWND__ *HWND;
+#endif
 
 #include <opencv2/opencv.hpp>
 
@@ -145,6 +152,14 @@ static const std::map<std::size_t, PinType> typeMap = {
     {typeid(ArrayElement).hash_code(), PinType::ArrayElement},
     {typeid(Object).hash_code(), PinType::Object},
 };
+
+// 类型对应的端口类型，每个类型只查一次表
+template <typename T>
+static PinType pin_type_of()
+{
+    static const PinType type = typeMap.at(typeid(T).hash_code());
+    return type;
+}
 static const std::map<PinType, std::string> typeLabelNames = {
     {PinType::Flow, "控制流"},
     {PinType::Int, "整数"},
@@ -366,6 +381,227 @@ static bool is_equal(const port_value_t &lft, const port_value_t &rht)
                       lft, rht);
 }
 
+// 图像和大数组，比较内容的开销和值的大小成正比
+template <typename T>
+struct is_large_value : std::false_type
+{
+};
+template <>
+struct is_large_value<cv::Mat> : std::true_type
+{
+};
+template <>
+struct is_large_value<Contour> : std::true_type
+{
+};
+template <>
+struct is_large_value<Contours> : std::true_type
+{
+};
+template <>
+struct is_large_value<KeyPoints> : std::true_type
+{
+};
+template <>
+struct is_large_value<Feature> : std::true_type
+{
+};
+template <>
+struct is_large_value<Matches> : std::true_type
+{
+};
+template <>
+struct is_large_value<Circles> : std::true_type
+{
+};
+template <typename T>
+inline constexpr bool is_large_value_v = is_large_value<T>::value;
+
+static bool is_large_port_value(const port_value_t &value)
+{
+    return std::visit([](auto &&v)
+                      { return is_large_value_v<std::decay_t<decltype(v)>>; },
+                      value);
+}
+
+// 端口值的共享句柄
+// 值创建后不再修改，复制句柄只增加引用计数；写入时替换为新的值，其他持有者看到的旧值不变
+// 端口、执行上下文和结果缓存之间传递轮廓、特征点等大数组时不再深拷贝
+class shared_port_value
+{
+public:
+    shared_port_value() : value(empty()) {}
+    shared_port_value(port_value_t value) : value(std::make_shared<const port_value_t>(std::move(value))) {}
+    template <typename T, typename = std::enable_if_t<std::is_constructible_v<port_value_t, T &&> && !std::is_same_v<std::decay_t<T>, port_value_t> && !std::is_same_v<std::decay_t<T>, shared_port_value>>>
+    shared_port_value(T &&value) : value(std::make_shared<const port_value_t>(std::forward<T>(value))) {}
+
+    const port_value_t &operator*() const { return *value; }
+    const port_value_t *operator->() const { return value.get(); }
+
+    // 只有这个句柄持有值时，丢弃句柄后值就被释放
+    bool unique() const { return value.use_count() == 1; }
+    bool same(const shared_port_value &other) const { return value == other.value; }
+
+private:
+    // 默认值共享同一个对象，不为每个端口分配
+    static const std::shared_ptr<const port_value_t> &empty()
+    {
+        static const std::shared_ptr<const port_value_t> value = std::make_shared<const port_value_t>();
+        return value;
+    }
+
+    std::shared_ptr<const port_value_t> value;
+};
+
+// 按类型读取的共享值，用于 get_value 读取大数组：只共享上游的值，不复制
+template <typename T>
+class shared_value
+{
+public:
+    shared_value() : handle(empty()) {}
+
+    const T &get() const { return std::get<T>(*handle); }
+    const T &operator*() const { return get(); }
+    const T *operator->() const { return &get(); }
+
+    const shared_port_value &get_handle() const { return handle; }
+
+    // 句柄中的值不是 T 时返回 false，保持原来的值
+    bool assign(const shared_port_value &value)
+    {
+        if (!std::holds_alternative<T>(*value))
+            return false;
+        handle = value;
+        return true;
+    }
+
+private:
+    static const shared_port_value &empty()
+    {
+        static const shared_port_value value{T()};
+        return value;
+    }
+
+    shared_port_value handle;
+};
+
+// 64 位哈希，每次处理 8 字节
+static uint64_t hash_bytes(const void *data, size_t size, uint64_t seed = 0xcbf29ce484222325ull)
+{
+    const uint64_t prime = 0x100000001b3ull;
+    auto bytes = static_cast<const unsigned char *>(data);
+    uint64_t hash = seed ^ (size * prime);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * prime;
+        hash ^= hash >> 29;
+    }
+    for (; i < size; i++)
+        hash = (hash ^ bytes[i]) * prime;
+    return hash;
+}
+
+// 计算端口值的内容哈希，无法计算哈希的类型返回空
+struct PortValueHasher
+{
+    uint64_t seed;
+
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic_v<T> || std::is_pointer_v<T>>>
+    std::optional<uint64_t> operator()(const T &v) const
+    {
+        return hash_bytes(&v, sizeof(T), seed);
+    }
+    std::optional<uint64_t> operator()(const std::string &v) const
+    {
+        return hash_bytes(v.data(), v.size(), seed);
+    }
+    std::optional<uint64_t> operator()(const cv::Mat &v) const
+    {
+        int header[] = {v.type(), v.dims, v.rows, v.cols};
+        uint64_t hash = hash_bytes(header, sizeof(header), seed);
+        if (v.empty())
+            return hash;
+        if (v.isContinuous())
+            return hash_bytes(v.ptr(), v.total() * v.elemSize(), hash);
+        const cv::Mat *arrays[] = {&v, 0};
+        uchar *ptrs[1];
+        cv::NAryMatIterator it(arrays, ptrs, 1);
+        for (unsigned int p = 0; p < it.nplanes; p++, ++it)
+            hash = hash_bytes(it.ptrs[0], it.size * v.elemSize(), hash);
+        return hash;
+    }
+    std::optional<uint64_t> operator()(const cv::Rect &v) const
+    {
+        int data[] = {v.x, v.y, v.width, v.height};
+        return hash_bytes(data, sizeof(data), seed);
+    }
+    std::optional<uint64_t> operator()(const cv::Size &v) const
+    {
+        int data[] = {v.width, v.height};
+        return hash_bytes(data, sizeof(data), seed);
+    }
+    std::optional<uint64_t> operator()(const cv::Point &v) const
+    {
+        int data[] = {v.x, v.y};
+        return hash_bytes(data, sizeof(data), seed);
+    }
+    std::optional<uint64_t> operator()(const cv::Scalar &v) const
+    {
+        return hash_bytes(v.val, sizeof(v.val), seed);
+    }
+    template <typename T, int n>
+    std::optional<uint64_t> operator()(const cv::Vec<T, n> &v) const
+    {
+        return hash_bytes(v.val, sizeof(v.val), seed);
+    }
+    std::optional<uint64_t> operator()(const cv::KeyPoint &v) const
+    {
+        float data[] = {v.pt.x, v.pt.y, v.size, v.angle, v.response};
+        int ids[] = {v.octave, v.class_id};
+        return hash_bytes(ids, sizeof(ids), hash_bytes(data, sizeof(data), seed));
+    }
+    std::optional<uint64_t> operator()(const cv::DMatch &v) const
+    {
+        int ids[] = {v.queryIdx, v.trainIdx, v.imgIdx};
+        return hash_bytes(&v.distance, sizeof(v.distance), hash_bytes(ids, sizeof(ids), seed));
+    }
+    template <typename T>
+    std::optional<uint64_t> operator()(const std::vector<T> &v) const
+    {
+        uint64_t hash = hash_bytes(nullptr, 0, seed ^ v.size());
+        for (auto &item : v)
+            hash = *PortValueHasher{hash}(item);
+        return hash;
+    }
+    std::optional<uint64_t> operator()(const Feature &v) const
+    {
+        return PortValueHasher{*(*this)(v.first)}(v.second);
+    }
+    std::optional<uint64_t> operator()(const EnumType &v) const
+    {
+        uint64_t hash = seed;
+        for (auto &[key, name] : v)
+            hash = hash_bytes(name.data(), name.size(), hash_bytes(&key, sizeof(key), hash));
+        return hash;
+    }
+    std::optional<uint64_t> operator()(const EnumValue &v) const
+    {
+        // 和 is_equal 一致，只比较枚举值
+        return hash_bytes(&v.second, sizeof(v.second), seed);
+    }
+    std::optional<uint64_t> operator()(const Array &) const { return std::nullopt; }
+    std::optional<uint64_t> operator()(const ArrayElement &) const { return std::nullopt; }
+    std::optional<uint64_t> operator()(const Object &) const { return std::nullopt; }
+};
+
+static std::optional<uint64_t> hash_value(const port_value_t &value)
+{
+    return std::visit(PortValueHasher{hash_bytes(nullptr, 0, value.index())}, value);
+}
+
 struct PortValueSerializer
 {
     json::value operator()(const ImVec2 &v) const
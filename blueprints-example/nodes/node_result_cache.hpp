@@ -0,0 +1,206 @@
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "node_port_types.hpp"
+
+// 节点执行结果缓存
+// 以（节点类型名称，参数值，上游值的内容哈希）为键缓存节点的输出，输入相同时直接发布缓存的输出
+// 按输出占用的字节数限制总大小，超出时淘汰最久未使用的结果
+class node_result_cache
+{
+public:
+    struct key_t
+    {
+        // 组成键的每一部分的哈希，用于在哈希冲突时确认
+        std::vector<uint64_t> parts;
+        uint64_t hash = 0;
+
+        bool operator==(const key_t &other) const
+        {
+            return hash == other.hash && parts == other.parts;
+        }
+    };
+
+    struct stats_t
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+    static key_t make_key(const std::vector<uint64_t> &parts)
+    {
+        key_t key;
+        key.parts = parts;
+        key.hash = hash_bytes(parts.data(), parts.size() * sizeof(uint64_t));
+        return key;
+    }
+
+    // 输出值大约占用的字节数，图像按像素数据计算
+    static size_t value_bytes(const port_value_t &value)
+    {
+        if (std::holds_alternative<cv::Mat>(value))
+        {
+            auto &mat = std::get<cv::Mat>(value);
+            return mat.total() * mat.elemSize();
+        }
+        if (std::holds_alternative<Feature>(value))
+        {
+            auto &feature = std::get<Feature>(value);
+            return feature.first.size() * sizeof(cv::KeyPoint) + feature.second.total() * feature.second.elemSize();
+        }
+        if (std::holds_alternative<std::string>(value))
+            return std::get<std::string>(value).size();
+        if (std::holds_alternative<Contours>(value))
+        {
+            size_t bytes = 0;
+            for (auto &contour : std::get<Contours>(value))
+                bytes += contour.size() * sizeof(cv::Point);
+            return bytes;
+        }
+        if (std::holds_alternative<Contour>(value))
+            return std::get<Contour>(value).size() * sizeof(cv::Point);
+        if (std::holds_alternative<KeyPoints>(value))
+            return std::get<KeyPoints>(value).size() * sizeof(cv::KeyPoint);
+        if (std::holds_alternative<Matches>(value))
+            return std::get<Matches>(value).size() * sizeof(cv::DMatch);
+        if (std::holds_alternative<Circles>(value))
+            return std::get<Circles>(value).size() * sizeof(cv::Vec3f);
+        return sizeof(port_value_t);
+    }
+
+    std::optional<std::vector<shared_port_value>> find(const key_t &key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(key.hash);
+        if (it == entries.end() || !(it->second->key == key))
+            return std::nullopt;
+        // 移动到最近使用
+        lru.splice(lru.begin(), lru, it->second);
+        return it->second->outputs;
+    }
+
+    void insert(const key_t &key, const std::vector<shared_port_value> &outputs)
+    {
+        size_t bytes = 0;
+        for (auto &output : outputs)
+            bytes += value_bytes(*output);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (bytes > budget_bytes)
+            return;
+        auto it = entries.find(key.hash);
+        if (it != entries.end())
+            erase(it->second);
+        lru.push_front({key, outputs, bytes});
+        entries[key.hash] = lru.begin();
+        used_bytes += bytes;
+        evict();
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        lru.clear();
+        entries.clear();
+        used_bytes = 0;
+    }
+
+    void set_budget(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        budget_bytes = bytes;
+        evict();
+    }
+
+    size_t get_budget()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return budget_bytes;
+    }
+
+    size_t get_used()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return used_bytes;
+    }
+
+    size_t get_count()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lru.size();
+    }
+
+    // 节点的命中统计
+    void record(uintptr_t node_id, bool hit)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &stat = node_stats[node_id];
+        if (hit)
+            stat.hits++;
+        else
+            stat.misses++;
+    }
+
+    stats_t get_stats(uintptr_t node_id)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = node_stats.find(node_id);
+        return it == node_stats.end() ? stats_t() : it->second;
+    }
+
+    // 端口值哈希的缓存：版本号不变时不需要重新计算哈希
+    std::optional<uint64_t> get_pin_hash(uintptr_t pin_id, uint64_t version, const port_value_t &value)
+    {
+        // 版本号为 0 的端口没有通过 SetValue 修改过，值可能被直接改写，不能缓存哈希
+        if (version != 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = pin_hashes.find(pin_id);
+            if (it != pin_hashes.end() && it->second.first == version)
+                return it->second.second;
+        }
+        auto hash = hash_value(value);
+        if (hash && version != 0)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pin_hashes[pin_id] = {version, *hash};
+        }
+        return hash;
+    }
+
+private:
+    struct entry_t
+    {
+        key_t key;
+        // 和端口共享的值，命中时直接发布，不复制
+        std::vector<shared_port_value> outputs;
+        size_t bytes = 0;
+    };
+    using lru_list_t = std::list<entry_t>;
+
+    void erase(lru_list_t::iterator it)
+    {
+        used_bytes -= it->bytes;
+        entries.erase(it->key.hash);
+        lru.erase(it);
+    }
+
+    void evict()
+    {
+        while (used_bytes > budget_bytes && !lru.empty())
+            erase(std::prev(lru.end()));
+    }
+
+    std::mutex mutex;
+    lru_list_t lru;
+    std::unordered_map<uint64_t, lru_list_t::iterator> entries;
+    std::unordered_map<uintptr_t, stats_t> node_stats;
+    std::unordered_map<uintptr_t, std::pair<uint64_t, uint64_t>> pin_hashes;
+    size_t budget_bytes = 256 * 1024 * 1024;
+    size_t used_bytes = 0;
+};
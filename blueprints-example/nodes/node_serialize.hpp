@@ -25,6 +25,7 @@ struct NodeSerializer
         obj["node_color"] = json::serialize(node->Color, PortValueSerializer());
         obj["node_size"] = json::serialize(node->Size, PortValueSerializer());
         obj["node_position"] = json::serialize(node->Position, PortValueSerializer());
+        obj["node_pinned"] = node->Pinned;
         json::array inputs;
         for (auto input : node->Inputs)
         {
@@ -34,7 +35,7 @@ struct NodeSerializer
             input_obj["input_name"] = input.Name;
             input_obj["input_type"] = static_cast<int>(input.Type);
             input_obj["input_type_label"] = typeLabelNames.at(input.Type);
-            input_obj["input_value"] = json::serialize(input.Value, PortValueSerializer());
+            input_obj["input_value"] = json::serialize(*input.Value, PortValueSerializer());
             input_obj["input_kind"] = static_cast<int>(input.Kind);
             inputs.push_back(input_obj);
         }
@@ -48,7 +49,7 @@ struct NodeSerializer
             output_obj["output_name"] = output.Name;
             output_obj["output_type"] = static_cast<int>(output.Type);
             output_obj["output_type_label"] = typeLabelNames.at(output.Type);
-            output_obj["output_value"] = json::serialize(output.Value, PortValueSerializer());
+            output_obj["output_value"] = json::serialize(*output.Value, PortValueSerializer());
             output_obj["output_kind"] = static_cast<int>(output.Kind);
             outputs.push_back(output_obj);
         }
@@ -81,6 +82,8 @@ struct NodeDeserializer
             json::deserialize(json.as_object().at("node_color"), node.Color, PortValueDeserializer());
             json::deserialize(json.as_object().at("node_size"), node.Size, PortValueDeserializer());
             json::deserialize(json.as_object().at("node_position"), node.Position, PortValueDeserializer());
+            if (json.as_object().contains("node_pinned"))
+                node.Pinned = json.as_object().at("node_pinned").as_boolean();
             auto inputs = json.as_object().at("inputs").as_array();
             for (auto input : inputs)
             {
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/parallel/parallel_backend.hpp>
+
+#include "../utilities/work_stealing_pool.hpp"
+
+// OpenCV 内部并行和图执行并行的协调
+// 节点在工作线程中执行，节点里的 OpenCV 函数又会用 cv::parallel_for_ 在 OpenCV 自己的线程池上并行，
+// 多个节点同时执行时两层并行的线程数相乘，线程远多于核心数
+// 把 OpenCV 的并行后端换成执行器的工作窃取线程池，按策略决定 cv::parallel_for_ 拆给多少个线程：
+//   opencv    不替换后端，使用 OpenCV 自己的线程池（替换后不能恢复，替换后按 all 处理）
+//   serial    节点内部不并行，只有节点之间的并行
+//   adaptive  只拆给当前空闲的工作线程：就绪节点少时节点内部并行，就绪节点多时各节点串行执行
+//   all       总是拆给所有工作线程，拆出的任务和节点一起在线程池中排队，不会创建多余的线程
+class opencv_parallel : public cv::parallel::ParallelForAPI
+{
+public:
+    enum class policy
+    {
+        opencv,
+        serial,
+        adaptive,
+        all,
+    };
+
+    static constexpr const char *policy_names[] = {"opencv", "serial", "adaptive", "all"};
+
+    static std::optional<policy> parse_policy(const std::string &name)
+    {
+        for (size_t i = 0; i < std::size(policy_names); i++)
+            if (name == policy_names[i])
+                return static_cast<policy>(i);
+        return std::nullopt;
+    }
+
+    static opencv_parallel &instance()
+    {
+        return *shared_instance();
+    }
+
+    // 设置策略，第一次设置为 opencv 以外的策略时替换 OpenCV 的并行后端
+    void set_policy(policy value)
+    {
+        current_policy = value;
+        install();
+    }
+
+    // 按当前策略替换 OpenCV 的并行后端，策略为 opencv 时不替换，替换只在第一次生效
+    // 执行器创建线程池时调用，默认策略为 adaptive
+    void install()
+    {
+        if (current_policy == policy::opencv)
+            return;
+        std::call_once(install_once, []()
+                       {
+                           cv::parallel::setParallelForBackend(shared_instance(), false);
+                           instance().installed = true; });
+    }
+
+    policy get_policy() const { return current_policy; }
+    bool is_installed() const { return installed; }
+
+    // 统计：直接在调用线程执行的次数、拆给其他线程的次数和拆出的任务数
+    struct stats_t
+    {
+        size_t inline_calls = 0;
+        size_t parallel_calls = 0;
+        size_t helper_tasks = 0;
+    };
+
+    stats_t get_stats() const
+    {
+        return {inline_calls, parallel_calls, helper_tasks};
+    }
+
+    void reset_stats()
+    {
+        inline_calls = 0;
+        parallel_calls = 0;
+        helper_tasks = 0;
+    }
+
+    void parallel_for(int tasks, FN_parallel_for_body_cb_t body_callback, void *callback_data) override
+    {
+        auto &pool = current_pool();
+        size_t helpers = 0;
+        switch (current_policy.load())
+        {
+        case policy::serial:
+            break;
+        case policy::adaptive:
+            helpers = pool.idle_worker_count();
+            break;
+        default:
+            helpers = pool.worker_count();
+            break;
+        }
+        helpers = std::min(helpers, static_cast<size_t>(std::max(tasks - 1, 0)));
+        // 线程序号不能超过 getNumThreads，OpenCV 按它分配每个线程的缓冲区
+        helpers = std::min(helpers, static_cast<size_t>(std::max(getNumThreads() - 1, 0)));
+        if (helpers == 0)
+        {
+            inline_calls++;
+            body_callback(0, tasks, callback_data);
+            return;
+        }
+        parallel_calls++;
+        helper_tasks += helpers;
+
+        // 条带按顺序领取，调用线程和拆出的任务一起领取，调用线程领不到条带后只等待已领取的条带结束
+        // 拆出的任务可能在调用返回之后才开始运行，这时已经领不到条带，不会再访问回调
+        struct job_t
+        {
+            std::atomic<int> next = 0;
+            std::atomic<int> done = 0;
+            int tasks = 0;
+            FN_parallel_for_body_cb_t body = nullptr;
+            void *data = nullptr;
+
+            // 调用线程的序号为 0，拆出的任务为 1..helpers
+            // 等待时可能在同一个线程上执行其他区域的任务，结束后恢复原来的序号
+            void run(int thread_index)
+            {
+                int previous = region_thread_index;
+                region_thread_index = thread_index;
+                int stripe;
+                while ((stripe = next++) < tasks)
+                {
+                    body(stripe, stripe + 1, data);
+                    done++;
+                }
+                region_thread_index = previous;
+            }
+        };
+        auto job = std::make_shared<job_t>();
+        job->tasks = tasks;
+        job->body = body_callback;
+        job->data = callback_data;
+        for (size_t i = 0; i < helpers; i++)
+            pool.post([job, index = static_cast<int>(i + 1)]()
+                      { job->run(index); });
+        job->run(0);
+        // 在工作线程中等待时帮忙执行其他任务，包括还没有开始的拆出任务
+        pool.wait_until([&job, tasks]()
+                        { return job->done >= tasks; });
+    }
+
+    // 当前线程在所在并行区域中的序号，不在并行区域中时为 0
+    int getThreadNum() const override
+    {
+        return region_thread_index;
+    }
+
+    int getNumThreads() const override
+    {
+        if (current_policy == policy::serial)
+            return 1;
+        int count = static_cast<int>(current_pool().worker_count());
+        return max_threads > 0 ? std::min(count, max_threads.load()) : count;
+    }
+
+    // 和 cv::setNumThreads 相同：0 表示不并行，负数表示恢复默认
+    int setNumThreads(int count) override
+    {
+        int previous = getNumThreads();
+        max_threads = count < 0 ? 0 : std::max(count, 1);
+        return previous;
+    }
+
+    const char *getName() const override
+    {
+        return "work_stealing_pool";
+    }
+
+private:
+    opencv_parallel() = default;
+
+    static const std::shared_ptr<opencv_parallel> &shared_instance()
+    {
+        static const std::shared_ptr<opencv_parallel> value(new opencv_parallel());
+        return value;
+    }
+
+    // 在工作线程中调用时使用所在的线程池，在界面线程等其他线程中调用时使用单独的线程池
+    work_stealing_pool &current_pool() const
+    {
+        if (auto pool = work_stealing_pool::current())
+            return *pool;
+        std::call_once(external_once, [this]()
+                       { external_pool = std::make_unique<work_stealing_pool>(); });
+        return *external_pool;
+    }
+
+    inline static thread_local int region_thread_index = 0;
+
+    std::atomic<policy> current_policy = policy::adaptive;
+    std::once_flag install_once;
+    std::atomic<bool> installed = false;
+    // cv::setNumThreads 设置的上限，0 表示不限制
+    std::atomic<int> max_threads = 0;
+    std::atomic<size_t> inline_calls = 0;
+    std::atomic<size_t> parallel_calls = 0;
+    std::atomic<size_t> helper_tasks = 0;
+    mutable std::once_flag external_once;
+    mutable std::unique_ptr<work_stealing_pool> external_pool;
+};
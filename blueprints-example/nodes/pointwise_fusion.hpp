@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// 逐像素运算
+// 每个通道使用相同的参数，结果按图像深度饱和，和 OpenCV 的 saturate_cast 一致
+struct pointwise_op
+{
+    enum class kind
+    {
+        // x + a，和 image + cv::Scalar(a) 一致：整数图像先把 a 取整
+        add,
+        // x * a，和 image * a、image / (1 / a) 一致
+        scale,
+        // |x * a + b|，和 cv::convertScaleAbs 一致，结果为 8 位无符号
+        scale_abs,
+    };
+
+    kind op = kind::add;
+    float a = 0;
+    float b = 0;
+
+    static pointwise_op add(float value) { return {kind::add, value, 0}; }
+    static pointwise_op scale(float value) { return {kind::scale, value, 0}; }
+    static pointwise_op scale_abs(float scale, float offset) { return {kind::scale_abs, scale, offset}; }
+};
+
+// 融合执行支持的图像深度，中间值用 float 表示，这些深度可以精确表示
+inline bool is_pointwise_depth(int depth)
+{
+    return depth == CV_8U || depth == CV_8S || depth == CV_16U || depth == CV_16S || depth == CV_32F;
+}
+
+inline int pointwise_result_depth(int depth, const std::vector<pointwise_op> &ops)
+{
+    for (auto &op : ops)
+        if (op.op == pointwise_op::kind::scale_abs)
+            depth = CV_8U;
+    return depth;
+}
+
+// 按深度饱和一行中间值
+// 整数深度先截断到范围内，再用加减 1.5 * 2^23 的方法就近舍入到偶数（和 cvRound 一致），这个循环可以被编译器向量化
+inline void saturate_pointwise_row(float *values, int count, int depth)
+{
+    float lo = 0, hi = 0;
+    switch (depth)
+    {
+    case CV_8U:
+        lo = 0, hi = 255;
+        break;
+    case CV_8S:
+        lo = -128, hi = 127;
+        break;
+    case CV_16U:
+        lo = 0, hi = 65535;
+        break;
+    case CV_16S:
+        lo = -32768, hi = 32767;
+        break;
+    default:
+        return;
+    }
+    constexpr float magic = 12582912.0f;
+    for (int i = 0; i < count; i++)
+    {
+        float x = std::min(std::max(values[i], lo), hi);
+        values[i] = (x + magic) - magic;
+    }
+}
+
+// 对一行中间值执行一步运算，depth 为这一步之前的深度，执行后更新为这一步结果的深度
+inline void apply_pointwise_row(float *values, int count, const pointwise_op &op, int &depth)
+{
+    switch (op.op)
+    {
+    case pointwise_op::kind::add:
+    {
+        const float value = depth == CV_32F ? op.a : static_cast<float>(cvRound(op.a));
+        for (int i = 0; i < count; i++)
+            values[i] += value;
+        break;
+    }
+    case pointwise_op::kind::scale:
+    {
+        const float value = op.a;
+        for (int i = 0; i < count; i++)
+            values[i] *= value;
+        break;
+    }
+    case pointwise_op::kind::scale_abs:
+    {
+        const float scale = op.a, offset = op.b;
+        for (int i = 0; i < count; i++)
+            values[i] = std::abs(values[i] * scale + offset);
+        depth = CV_8U;
+        break;
+    }
+    }
+    saturate_pointwise_row(values, count, depth);
+}
+
+// 一次遍历执行一串逐像素运算
+// 按行条带并行，每个条带只使用一行大小的 float 缓冲区，不为中间结果分配整幅图像
+// 每一步之后按当前深度饱和，结果和逐个节点执行相同
+// dst 的大小和类型相同时直接写入，dst 不能和 src 共享内存
+inline void apply_pointwise(const cv::Mat &src, const std::vector<pointwise_op> &ops, cv::Mat &dst)
+{
+    CV_Assert(is_pointwise_depth(src.depth()));
+    const int depth = pointwise_result_depth(src.depth(), ops);
+    dst.create(src.size(), CV_MAKETYPE(depth, src.channels()));
+    if (src.empty())
+        return;
+
+    const int width = src.cols * src.channels();
+    // 每个条带大约 64K 个元素
+    const double stripes = std::max(1.0, static_cast<double>(src.rows) * width / (64 * 1024));
+    cv::parallel_for_(
+        cv::Range(0, src.rows), [&](const cv::Range &range)
+        {
+            std::vector<float> buffer(width);
+            cv::Mat row_buffer(1, width, CV_32F, buffer.data());
+            for (int y = range.start; y < range.end; y++)
+            {
+                src.row(y).reshape(1, 1).convertTo(row_buffer, CV_32F);
+                int current = src.depth();
+                for (auto &op : ops)
+                    apply_pointwise_row(buffer.data(), width, op, current);
+                cv::Mat dst_row = dst.row(y).reshape(1, 1);
+                row_buffer.convertTo(dst_row, depth);
+            } },
+        stripes);
+}
@@ -0,0 +1,223 @@
+#pragma once
+
+#define IMGUI_DEFINE_MATH_OPERATORS
+#include <imgui.h>
+#include <imgui_internal.h>
+
+#include "base_nodes.hpp"
+
+// 性能面板：最近若干次执行中每个节点的耗时分位数、最近一次执行的线程时间线和各类型节点的耗时占比
+// 点击表格中的节点在画布上选中并定位到该节点
+
+inline ImU32 profiler_type_color(const std::string &type)
+{
+    auto hash = static_cast<uint32_t>(std::hash<std::string>()(type));
+    float r, g, b;
+    ImGui::ColorConvertHSVtoRGB((hash % 360) / 360.0f, 0.55f, 0.85f, r, g, b);
+    return ImColor(r, g, b);
+}
+
+inline void sort_profiler_stats(std::vector<execution_profile::node_stats> &stats, const ImGuiTableSortSpecs *specs)
+{
+    if (!specs || specs->SpecsCount == 0)
+        return;
+    auto &spec = specs->Specs[0];
+    auto key = [&spec](const execution_profile::node_stats &s) -> double
+    {
+        switch (spec.ColumnIndex)
+        {
+        case 2:
+            return static_cast<double>(s.count);
+        case 3:
+            return s.p50;
+        case 4:
+            return s.p95;
+        case 5:
+            return s.p99;
+        case 6:
+            return s.mean;
+        default:
+            return s.total_ms;
+        }
+    };
+    std::stable_sort(stats.begin(), stats.end(), [&](const auto &a, const auto &b)
+                     {
+                         if (spec.ColumnIndex == 0)
+                             return spec.SortDirection == ImGuiSortDirection_Ascending ? a.name < b.name : a.name > b.name;
+                         if (spec.ColumnIndex == 1)
+                             return spec.SortDirection == ImGuiSortDirection_Ascending ? a.type < b.type : a.type > b.type;
+                         return spec.SortDirection == ImGuiSortDirection_Ascending ? key(a) < key(b) : key(a) > key(b); });
+}
+
+// 节点耗时的直方图，横轴从最短到最长耗时等分
+inline void draw_profiler_histogram(const std::vector<double> &durations, float width)
+{
+    if (durations.empty())
+        return;
+    constexpr int bins = 24;
+    auto [min_it, max_it] = std::minmax_element(durations.begin(), durations.end());
+    double lo = *min_it, hi = *max_it;
+    std::vector<float> counts(bins, 0);
+    for (auto ms : durations)
+    {
+        int bin = hi > lo ? static_cast<int>((ms - lo) / (hi - lo) * bins) : 0;
+        counts[std::clamp(bin, 0, bins - 1)]++;
+    }
+    char overlay[64];
+    snprintf(overlay, sizeof(overlay), "%.2f ms - %.2f ms", lo, hi);
+    ImGui::PlotHistogram("##耗时分布", counts.data(), bins, 0, overlay, 0, FLT_MAX, ImVec2(width, 80));
+}
+
+// 最近一次执行的时间线，每个线程一行，节点按类型着色
+inline void draw_profiler_timeline(const execution_profile::run &run, uintptr_t &selected)
+{
+    const float lane_height = ImGui::GetTextLineHeight() + 4;
+    const float label_width = ImGui::CalcTextSize("线程 00").x + 8;
+    const ImVec2 size(ImGui::GetContentRegionAvail().x, lane_height * std::max<size_t>(run.lanes, 1));
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("##时间线", size);
+    const bool clicked = ImGui::IsItemClicked();
+    auto draw_list = ImGui::GetWindowDrawList();
+    const float scale = run.total_ms > 0 ? (size.x - label_width) / static_cast<float>(run.total_ms) : 0;
+
+    for (size_t lane = 0; lane < run.lanes; lane++)
+    {
+        ImVec2 row(origin.x, origin.y + lane * lane_height);
+        draw_list->AddRectFilled(row, row + ImVec2(size.x, lane_height), lane % 2 ? IM_COL32(255, 255, 255, 10) : IM_COL32(255, 255, 255, 20));
+        draw_list->AddText(row + ImVec2(2, 2), ImGui::GetColorU32(ImGuiCol_TextDisabled), ("线程 " + std::to_string(lane)).c_str());
+    }
+    for (auto &s : run.samples)
+    {
+        ImVec2 p0(origin.x + label_width + static_cast<float>(s.begin_ms) * scale, origin.y + s.lane * lane_height + 1);
+        ImVec2 p1(origin.x + label_width + static_cast<float>(s.end_ms) * scale, p0.y + lane_height - 2);
+        p1.x = std::max(p1.x, p0.x + 1);
+        draw_list->AddRectFilled(p0, p1, profiler_type_color(s.type), 2.0f);
+        if (s.node_id == selected)
+            draw_list->AddRect(p0, p1, IM_COL32(255, 255, 255, 255), 2.0f, 0, 2.0f);
+        if (p1.x - p0.x > ImGui::CalcTextSize(s.name.c_str()).x + 4)
+        {
+            draw_list->PushClipRect(p0, p1, true);
+            draw_list->AddText(p0 + ImVec2(2, 1), IM_COL32(20, 20, 20, 255), s.name.c_str());
+            draw_list->PopClipRect();
+        }
+        if (ImGui::IsMouseHoveringRect(p0, p1))
+        {
+            ImGui::SetTooltip("%s (%s)\n执行: %.3f ms\n排队: %.3f ms\n开始: %.3f ms", s.name.c_str(), s.type.c_str(), s.end_ms - s.begin_ms, s.queue_wait_ms, s.begin_ms);
+            if (clicked)
+                selected = s.node_id;
+        }
+    }
+}
+
+inline void draw_profiler_window(Graph &graph, bool *open)
+{
+    if (!ImGui::Begin("执行性能", open))
+    {
+        ImGui::End();
+        return;
+    }
+    auto &env = graph.env;
+    auto &profile = env.profile;
+    static uintptr_t selected = 0;
+    const auto previous = selected;
+
+    bool profiling = env.profiling;
+    if (ImGui::Checkbox("记录性能", &profiling))
+        env.profiling = profiling;
+    ImGui::SameLine();
+    static int capacity = static_cast<int>(profile.get_capacity());
+    ImGui::SetNextItemWidth(100);
+    if (ImGui::InputInt("保留次数", &capacity, 8))
+    {
+        capacity = std::clamp(capacity, 1, 4096);
+        profile.set_capacity(capacity);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("清空"))
+        profile.clear();
+    ImGui::SameLine();
+    ImGui::Text("已记录 %zu 次执行", profile.get_run_count());
+
+    auto latest = profile.latest();
+    if (!latest)
+    {
+        ImGui::TextDisabled("执行一次后显示各节点的耗时");
+        ImGui::End();
+        return;
+    }
+
+    if (ImGui::CollapsingHeader("节点耗时", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        auto stats = profile.get_node_stats();
+        const auto flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY;
+        const float height = ImGui::GetTextLineHeightWithSpacing() * std::min<size_t>(stats.size() + 1, 12) + 8;
+        if (ImGui::BeginTable("节点耗时", 8, flags, ImVec2(0, height)))
+        {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("节点");
+            ImGui::TableSetupColumn("类型");
+            ImGui::TableSetupColumn("次数");
+            ImGui::TableSetupColumn("p50 ms");
+            ImGui::TableSetupColumn("p95 ms");
+            ImGui::TableSetupColumn("p99 ms");
+            ImGui::TableSetupColumn("平均 ms");
+            ImGui::TableSetupColumn("总计 ms", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+            ImGui::TableHeadersRow();
+            sort_profiler_stats(stats, ImGui::TableGetSortSpecs());
+            for (auto &s : stats)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::PushID(reinterpret_cast<void *>(s.node_id));
+                if (ImGui::Selectable(s.name.c_str(), s.node_id == selected, ImGuiSelectableFlags_SpanAllColumns))
+                    selected = s.node_id;
+                ImGui::PopID();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(s.type.c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%zu", s.count);
+                for (auto value : {s.p50, s.p95, s.p99, s.mean, s.total_ms})
+                {
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", value);
+                }
+            }
+            ImGui::EndTable();
+        }
+        if (selected)
+        {
+            auto durations = profile.get_node_durations(selected);
+            if (!durations.empty())
+            {
+                ImGui::Text("耗时分布 (%zu 次)", durations.size());
+                draw_profiler_histogram(durations, ImGui::GetContentRegionAvail().x);
+            }
+        }
+    }
+
+    if (ImGui::CollapsingHeader("最近一次执行", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        ImGui::Text("总耗时 %.3f ms，%zu 个节点，%zu 个线程", latest->total_ms, latest->samples.size(), latest->lanes);
+        draw_profiler_timeline(*latest, selected);
+    }
+
+    if (ImGui::CollapsingHeader("类型占比", ImGuiTreeNodeFlags_DefaultOpen))
+    {
+        for (auto &[type, share] : profile.get_type_shares())
+        {
+            char overlay[128];
+            snprintf(overlay, sizeof(overlay), "%s %.1f%%", type.c_str(), share * 100);
+            ImGui::PushStyleColor(ImGuiCol_PlotHistogram, profiler_type_color(type));
+            ImGui::ProgressBar(static_cast<float>(share), ImVec2(-1, 0), overlay);
+            ImGui::PopStyleColor();
+        }
+    }
+
+    // 选中的节点变化时在画布上选中并定位，节点已经被删除时不处理
+    if (selected != previous && graph.FindNode(ed::NodeId(selected)))
+    {
+        ed::SelectNode(ed::NodeId(selected), false);
+        ed::NavigateToSelection();
+    }
+    ImGui::End();
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 资源类别并发限制
+// 节点声明 "名称:上限" 形式的资源类别（如 "ocr:1"），同一类别同时执行的节点数量不超过上限
+// 名额已满时节点排队而不是阻塞工作线程：排队的节点在名额释放时由释放者转交名额并重新提交
+class resource_limiter
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    struct stats_t
+    {
+        std::string name;
+        int limit = 0;
+        int running = 0;
+        size_t waiting = 0;
+        // 取得名额的次数，其中需要排队的次数和排队时间
+        size_t acquired = 0;
+        size_t waits = 0;
+        double total_wait_ms = 0;
+        double max_wait_ms = 0;
+    };
+
+    // 解析 "名称:上限"，没有上限或上限无效时为 1
+    static std::pair<std::string, int> parse(const std::string &resource)
+    {
+        auto colon = resource.rfind(':');
+        if (colon == std::string::npos)
+            return {resource, 1};
+        int limit = std::atoi(resource.c_str() + colon + 1);
+        return {resource.substr(0, colon), std::max(limit, 1)};
+    }
+
+    // 取得名额时返回 true
+    // 名额已满时返回 false，resume 进入排队，名额释放时被调用，调用时名额已经属于它，结束后同样需要 release
+    bool acquire(const std::string &resource, std::function<void()> resume)
+    {
+        auto [name, limit] = parse(resource);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &c = classes[name];
+        c.limit = limit;
+        if (c.running < c.limit)
+        {
+            c.running++;
+            c.acquired++;
+            return true;
+        }
+        c.waiting.push_back({std::move(resume), clock::now()});
+        return false;
+    }
+
+    void release(const std::string &resource)
+    {
+        std::function<void()> resume;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto &c = classes[parse(resource).first];
+            // 上限调小后多出的名额不再转交
+            if (c.waiting.empty() || c.running > c.limit)
+            {
+                c.running--;
+                return;
+            }
+            auto waiter = std::move(c.waiting.front());
+            c.waiting.pop_front();
+            double ms = std::chrono::duration<double, std::milli>(clock::now() - waiter.since).count();
+            c.acquired++;
+            c.waits++;
+            c.total_wait_ms += ms;
+            c.max_wait_ms = std::max(c.max_wait_ms, ms);
+            resume = std::move(waiter.resume);
+        }
+        resume();
+    }
+
+    std::vector<stats_t> get_stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<stats_t> result;
+        for (auto &[name, c] : classes)
+        {
+            stats_t s;
+            s.name = name;
+            s.limit = c.limit;
+            s.running = c.running;
+            s.waiting = c.waiting.size();
+            s.acquired = c.acquired;
+            s.waits = c.waits;
+            s.total_wait_ms = c.total_wait_ms;
+            s.max_wait_ms = c.max_wait_ms;
+            result.push_back(std::move(s));
+        }
+        return result;
+    }
+
+    void reset_stats()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &[name, c] : classes)
+        {
+            c.acquired = 0;
+            c.waits = 0;
+            c.total_wait_ms = 0;
+            c.max_wait_ms = 0;
+        }
+    }
+
+private:
+    struct waiter
+    {
+        std::function<void()> resume;
+        clock::time_point since;
+    };
+
+    struct resource_class
+    {
+        int limit = 1;
+        int running = 0;
+        std::deque<waiter> waiting;
+        size_t acquired = 0;
+        size_t waits = 0;
+        double total_wait_ms = 0;
+        double max_wait_ms = 0;
+    };
+
+    std::mutex mutex;
+    std::map<std::string, resource_class> classes;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// 局部运算：输出的每个像素只依赖输入中以它为中心、半径为 radius 的邻域
+// 图像边界外的像素按 border_type 填充，和整幅图像执行时 OpenCV 的处理一致
+struct local_op
+{
+    using apply_t = std::function<void(const cv::Mat &src, cv::Mat &dst)>;
+
+    cv::Size radius;
+    int border_type = cv::BORDER_DEFAULT;
+    cv::Scalar border_value;
+    // 在已经填充好邻域的图像上执行，输出和输入大小相同
+    apply_t apply;
+    // 输出的深度，和 OpenCV 一样 -1 表示和输入相同，链中下一个节点按它得知自己输入的类型
+    int ddepth = -1;
+
+    static local_op square(int radius, int border_type, apply_t apply, int ddepth = -1)
+    {
+        return {cv::Size(radius, radius), border_type, cv::Scalar(), std::move(apply), ddepth};
+    }
+};
+
+// 分块时只能用块附近的像素填充边界，BORDER_WRAP 需要图像另一侧的像素
+inline bool is_tileable_border(int border_type)
+{
+    border_type &= ~cv::BORDER_ISOLATED;
+    return border_type == cv::BORDER_CONSTANT || border_type == cv::BORDER_REPLICATE ||
+           border_type == cv::BORDER_REFLECT || border_type == cv::BORDER_REFLECT_101;
+}
+
+// 按块计算一串局部运算中的一块
+// 第 k 步的输出区域是块向外扩展后面所有步骤半径之和（限制在图像内），输入区域再扩展本步的半径
+// 扩展超出图像的部分按本步的边界类型填充，其余都是上一步算出的真实像素，所以保留下来的输出和整幅图像执行相同
+inline cv::Mat apply_local_tile(const cv::Mat &src, const std::vector<local_op> &ops, const cv::Rect &tile)
+{
+    const cv::Rect bounds(0, 0, src.cols, src.rows);
+    std::vector<cv::Size> halo(ops.size() + 1);
+    for (size_t k = ops.size(); k-- > 0;)
+        halo[k] = halo[k + 1] + ops[k].radius;
+
+    auto expand = [](const cv::Rect &rect, cv::Size size)
+    {
+        return cv::Rect(rect.x - size.width, rect.y - size.height, rect.width + size.width * 2, rect.height + size.height * 2);
+    };
+
+    cv::Mat current = src;
+    cv::Rect current_rect = bounds;
+    for (size_t k = 0; k < ops.size(); k++)
+    {
+        auto &op = ops[k];
+        cv::Rect output_rect = expand(tile, halo[k + 1]) & bounds;
+        cv::Rect need = expand(output_rect, op.radius);
+        cv::Rect have = need & bounds;
+        cv::Mat input = current(have - current_rect.tl());
+        cv::Mat padded;
+        int top = have.y - need.y, left = have.x - need.x;
+        int bottom = need.br().y - have.br().y, right = need.br().x - have.br().x;
+        if (top || bottom || left || right)
+            cv::copyMakeBorder(input, padded, top, bottom, left, right, op.border_type | cv::BORDER_ISOLATED, op.border_value);
+        else
+            padded = input;
+
+        cv::Mat output;
+        op.apply(padded, output);
+        CV_Assert(output.size() == padded.size());
+        current = output(cv::Rect(output_rect.tl() - need.tl(), output_rect.size()));
+        current_rect = output_rect;
+    }
+    return current;
+}
+
+// 把图像分成 tile_size 大小的块，每块带上足够的邻域并行执行整串局部运算，再拼回整幅图像
+// 中间结果只有块大小，不为每一步分配整幅图像
+// dst 的大小和类型相同时直接写入，dst 不能和 src 共享内存
+inline void apply_tiled(const cv::Mat &src, const std::vector<local_op> &ops, int tile_size, cv::Mat &dst)
+{
+    CV_Assert(!src.empty() && tile_size > 0);
+    const int columns = (src.cols + tile_size - 1) / tile_size;
+    const int rows = (src.rows + tile_size - 1) / tile_size;
+    auto tile_rect = [&](int index)
+    {
+        int x = index % columns * tile_size, y = index / columns * tile_size;
+        return cv::Rect(x, y, std::min(tile_size, src.cols - x), std::min(tile_size, src.rows - y));
+    };
+
+    // 先算第一块得到输出的类型
+    cv::Mat first = apply_local_tile(src, ops, tile_rect(0));
+    dst.create(src.size(), first.type());
+    first.copyTo(dst(tile_rect(0)));
+    cv::parallel_for_(
+        cv::Range(1, columns * rows), [&](const cv::Range &range)
+        {
+            for (int i = range.start; i < range.end; i++)
+            {
+                auto rect = tile_rect(i);
+                cv::Mat tile = apply_local_tile(src, ops, rect);
+                CV_Assert(tile.type() == dst.type());
+                tile.copyTo(dst(rect));
+            } });
+}
@@ -0,0 +1,517 @@
+// 无界面批量执行工程文件
+// 读取 Graph::serialize 保存的工程，通过节点工厂重新绑定节点的执行函数，不创建窗口、平台和渲染器直接执行
+// 用法：image-graph-run <工程文件> [选项]
+//   -n, --repeat N           重复执行 N 次，默认 1 次
+//   --each DIR NODE.PIN      对目录中的每个文件执行一次，文件路径写入指定的字符串输入端口
+//   --set NODE.PIN=VALUE     覆盖输入端口的值，可以多次指定
+//   -p, --parallel N         和 --each 一起使用，每个文件一个执行上下文，最多同时执行 N 个
+//   -j, --workers N          工作线程数，默认使用硬件线程数
+//   --cv-threads POLICY      节点里 OpenCV 并行运算的线程策略：opencv、serial、adaptive（默认）、all
+//   --full                   关闭增量执行，每次执行所有节点
+//   --cache                  开启结果缓存
+//   --fingerprint            所有节点的图像和大数组写入时比较内容指纹，内容不变时下游节点不重新执行（总是执行的节点始终比较）
+//   --trace FILE             把所有执行的轨迹写入 Chrome trace 格式的文件，可以在 Perfetto 中打开
+//   --low-memory             图像输出的所有读者结束后立即释放，输出本次执行的图像内存峰值
+//   --tile N                 局部运算节点链按 N 像素的块执行，0 关闭分块执行，默认关闭
+//   -q, --quiet              不输出每次执行的结果
+//   --export DIR             不执行，把工程导出为独立的 C++ 程序写入目录（应用 --set 之后的值）
+// NODE 为节点 ID 或节点名称，PIN 为输入端口名称或序号
+
+#include "base_nodes.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+    struct pin_ref
+    {
+        std::string node;
+        std::string pin;
+    };
+
+    struct options
+    {
+        std::string project;
+        int repeat = 1;
+        std::optional<std::pair<std::string, pin_ref>> each;
+        std::vector<std::pair<pin_ref, std::string>> overrides;
+        size_t workers = 0;
+        opencv_parallel::policy cv_policy = opencv_parallel::policy::adaptive;
+        size_t parallel = 1;
+        bool incremental = true;
+        bool cache = false;
+        bool fingerprint = false;
+        std::string trace_path;
+        int tile_size = 0;
+        bool low_memory = false;
+        bool quiet = false;
+        std::string export_dir;
+    };
+
+    void print_usage()
+    {
+        printf("用法: image-graph-run <工程文件> [-n 次数] [--each 目录 节点.端口] [--set 节点.端口=值]... [-p 并行数] [-j 线程数] [--cv-threads 策略] [--full] [--cache] [--fingerprint] [--trace 文件] [--tile 块大小] [--low-memory] [-q] [--export 目录]\n");
+    }
+
+    std::optional<pin_ref> parse_pin_ref(const std::string &text)
+    {
+        auto dot = text.find('.');
+        if (dot == std::string::npos || dot == 0 || dot + 1 == text.size())
+            return std::nullopt;
+        return pin_ref{text.substr(0, dot), text.substr(dot + 1)};
+    }
+
+    std::optional<options> parse_options(int argc, char *argv[])
+    {
+        options opts;
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+            auto has_values = [&](int count)
+            {
+                return i + count < argc;
+            };
+            if ((arg == "-n" || arg == "--repeat") && has_values(1))
+                opts.repeat = std::max(1, std::atoi(argv[++i]));
+            else if (arg == "--each" && has_values(2))
+            {
+                std::string dir = argv[++i];
+                auto ref = parse_pin_ref(argv[++i]);
+                if (!ref)
+                    return std::nullopt;
+                opts.each = std::make_pair(dir, *ref);
+            }
+            else if (arg == "--set" && has_values(1))
+            {
+                std::string assignment = argv[++i];
+                auto eq = assignment.find('=');
+                auto ref = eq == std::string::npos ? std::nullopt : parse_pin_ref(assignment.substr(0, eq));
+                if (!ref)
+                    return std::nullopt;
+                opts.overrides.emplace_back(*ref, assignment.substr(eq + 1));
+            }
+            else if ((arg == "-p" || arg == "--parallel") && has_values(1))
+                opts.parallel = static_cast<size_t>(std::max(1, std::atoi(argv[++i])));
+            else if ((arg == "-j" || arg == "--workers") && has_values(1))
+                opts.workers = static_cast<size_t>(std::max(0, std::atoi(argv[++i])));
+            else if (arg == "--cv-threads" && has_values(1))
+            {
+                auto policy = opencv_parallel::parse_policy(argv[++i]);
+                if (!policy)
+                    return std::nullopt;
+                opts.cv_policy = *policy;
+            }
+            else if (arg == "--full")
+                opts.incremental = false;
+            else if (arg == "--cache")
+                opts.cache = true;
+            else if (arg == "--fingerprint")
+                opts.fingerprint = true;
+            else if (arg == "--trace" && has_values(1))
+                opts.trace_path = argv[++i];
+            else if (arg == "--low-memory")
+                opts.low_memory = true;
+            else if (arg == "--tile" && has_values(1))
+                opts.tile_size = std::max(0, std::atoi(argv[++i]));
+            else if (arg == "-q" || arg == "--quiet")
+                opts.quiet = true;
+            else if (arg == "--export" && has_values(1))
+                opts.export_dir = argv[++i];
+            else if (opts.project.empty() && arg[0] != '-')
+                opts.project = arg;
+            else
+                return std::nullopt;
+        }
+        if (opts.project.empty())
+            return std::nullopt;
+        return opts;
+    }
+
+    bool is_number(const std::string &text)
+    {
+        return !text.empty() && std::all_of(text.begin(), text.end(), [](char c)
+                                            { return c >= '0' && c <= '9'; });
+    }
+
+    // 按 ID 或名称查找节点，名称重复时要求使用 ID
+    Node *find_node(Graph &graph, const std::string &name, std::string &error)
+    {
+        if (is_number(name))
+        {
+            if (auto node = graph.FindNode(ed::NodeId(std::stoull(name))))
+                return node;
+        }
+        Node *found = nullptr;
+        for (auto &node : graph.Nodes)
+        {
+            if (node.Name != name)
+                continue;
+            if (found)
+            {
+                error = "节点名称不唯一，请使用节点 ID: " + name;
+                return nullptr;
+            }
+            found = &node;
+        }
+        if (!found)
+            error = "找不到节点: " + name;
+        return found;
+    }
+
+    Pin *find_input(Graph &graph, const pin_ref &ref, std::string &error)
+    {
+        auto node = find_node(graph, ref.node, error);
+        if (!node)
+            return nullptr;
+        if (is_number(ref.pin))
+        {
+            size_t index = std::stoul(ref.pin);
+            if (index < node->Inputs.size())
+                return &node->Inputs[index];
+        }
+        for (auto &input : node->Inputs)
+            if (input.Name == ref.pin)
+                return &input;
+        error = "节点 " + node->Name + " 没有输入端口: " + ref.pin;
+        return nullptr;
+    }
+
+    template <typename T, size_t N>
+    bool parse_numbers(const std::string &text, T (&values)[N], size_t min_count)
+    {
+        std::stringstream stream(text);
+        std::string item;
+        size_t count = 0;
+        while (std::getline(stream, item, ','))
+        {
+            if (count == N)
+                return false;
+            std::stringstream number(item);
+            if (!(number >> values[count++]))
+                return false;
+        }
+        return count >= min_count;
+    }
+
+    // 按端口类型解析命令行中的值
+    std::optional<port_value_t> parse_value(PinType type, const std::string &text)
+    {
+        try
+        {
+            switch (type)
+            {
+            case PinType::Bool:
+                return port_value_t(text == "true" || text == "1");
+            case PinType::Int:
+                return port_value_t(std::stoi(text));
+            case PinType::Float:
+                return port_value_t(std::stof(text));
+            case PinType::String:
+                return port_value_t(text);
+            case PinType::Image:
+            {
+                auto image = cv::imread(text, cv::IMREAD_UNCHANGED);
+                if (image.empty())
+                    return std::nullopt;
+                return port_value_t(image);
+            }
+            case PinType::Point:
+            {
+                int values[2] = {};
+                if (!parse_numbers(text, values, 2))
+                    return std::nullopt;
+                return port_value_t(cv::Point(values[0], values[1]));
+            }
+            case PinType::Size:
+            {
+                int values[2] = {};
+                if (!parse_numbers(text, values, 2))
+                    return std::nullopt;
+                return port_value_t(cv::Size(values[0], values[1]));
+            }
+            case PinType::Rect:
+            {
+                int values[4] = {};
+                if (!parse_numbers(text, values, 4))
+                    return std::nullopt;
+                return port_value_t(cv::Rect(values[0], values[1], values[2], values[3]));
+            }
+            case PinType::Color:
+            {
+                double values[4] = {0, 0, 0, 255};
+                if (!parse_numbers(text, values, 3))
+                    return std::nullopt;
+                return port_value_t(cv::Scalar(values[0], values[1], values[2], values[3]));
+            }
+            default:
+                return std::nullopt;
+            }
+        }
+        catch (const std::exception &)
+        {
+            return std::nullopt;
+        }
+    }
+
+    bool set_input(Graph &graph, const pin_ref &ref, const std::string &text)
+    {
+        std::string error;
+        auto pin = find_input(graph, ref, error);
+        if (!pin)
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            return false;
+        }
+        if (graph.IsPinLinked(pin->ID))
+            fprintf(stderr, "警告: 端口 %s.%s 已有连线，覆盖的值不会被使用\n", ref.node.c_str(), ref.pin.c_str());
+        auto value = parse_value(pin->Type, text);
+        if (!value)
+        {
+            fprintf(stderr, "无法将 \"%s\" 解析为端口 %s.%s 的类型\n", text.c_str(), ref.node.c_str(), ref.pin.c_str());
+            return false;
+        }
+        pin->SetPortValue(*value);
+        return true;
+    }
+
+    struct run_result
+    {
+        double ms = 0;
+        size_t errors = 0;
+    };
+
+    run_result run_once(Graph &graph, const std::string &label, bool quiet)
+    {
+        auto begin = std::chrono::steady_clock::now();
+        graph.env.ExecuteNodes();
+        auto end = std::chrono::steady_clock::now();
+
+        run_result result;
+        result.ms = std::chrono::duration<double, std::milli>(end - begin).count();
+        for (auto &node : graph.Nodes)
+        {
+            if (!node.LastExecuteResult.has_error())
+                continue;
+            result.errors++;
+            if (!quiet)
+                fprintf(stderr, "  [%zu] %s: %s\n", static_cast<size_t>(node.ID.Get()), node.Name.c_str(), node.LastExecuteResult.Error->Message.c_str());
+        }
+        if (!quiet)
+            printf("%s: %.3f ms, 执行 %zu 个节点, 沿用 %zu 个节点, 错误 %zu 个, 图像内存峰值 %.1f MB, 图像分配 %zu 次\n", label.c_str(), result.ms, graph.env.executed_count.load(), graph.env.reused_count.load(), result.errors,
+                   graph.env.peak_resident_bytes / (1024.0 * 1024.0), graph.env.last_run_allocations.load());
+        return result;
+    }
+
+    // 每个输入文件一个上下文，多个上下文同时执行同一个图
+    bool run_contexts(Graph &graph, const options &opts, const std::vector<std::string> &inputs, std::vector<double> &latencies, size_t &failed_runs)
+    {
+        std::string error;
+        auto pin = find_input(graph, opts.each->second, error);
+        if (!pin)
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            return false;
+        }
+
+        struct job_t
+        {
+            std::string label;
+            std::shared_ptr<execution_context> context;
+            std::future<void> future;
+            std::chrono::steady_clock::time_point begin;
+        };
+        std::deque<job_t> running;
+        auto finish = [&]()
+        {
+            auto job = std::move(running.front());
+            running.pop_front();
+            job.future.get();
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - job.begin).count();
+            size_t errors = 0;
+            for (auto &node : graph.Nodes)
+            {
+                auto result = job.context->get_result(node.ID);
+                if (!result.has_error())
+                    continue;
+                errors++;
+                if (!opts.quiet)
+                    fprintf(stderr, "  [%zu] %s: %s\n", static_cast<size_t>(node.ID.Get()), node.Name.c_str(), result.Error->Message.c_str());
+            }
+            if (!opts.quiet)
+                printf("%s: %.3f ms, 错误 %zu 个\n", job.label.c_str(), ms, errors);
+            latencies.push_back(ms);
+            if (errors > 0)
+                failed_runs++;
+        };
+
+        for (auto &input : inputs)
+        {
+            auto value = parse_value(pin->Type, input);
+            if (!value)
+            {
+                fprintf(stderr, "无法将 \"%s\" 解析为端口 %s.%s 的类型\n", input.c_str(), opts.each->second.node.c_str(), opts.each->second.pin.c_str());
+                return false;
+            }
+            for (int i = 0; i < opts.repeat; i++)
+            {
+                if (running.size() >= opts.parallel)
+                    finish();
+                job_t job;
+                job.label = input + " #" + std::to_string(i + 1);
+                job.context = std::make_shared<execution_context>();
+                job.context->set(pin->ID, *value);
+                job.begin = std::chrono::steady_clock::now();
+                job.future = graph.env.async_execute_context(job.context);
+                running.push_back(std::move(job));
+            }
+        }
+        while (!running.empty())
+            finish();
+        return true;
+    }
+
+    double percentile(std::vector<double> sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+        auto index = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+        return sorted[std::min(index, sorted.size() - 1)];
+    }
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    auto opts = parse_options(argc, argv);
+    if (!opts)
+    {
+        print_usage();
+        return 2;
+    }
+
+    std::ifstream in(opts->project);
+    if (!in)
+    {
+        fprintf(stderr, "无法打开工程文件: %s\n", opts->project.c_str());
+        return 2;
+    }
+    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    // 没有界面，图像端口不生成纹理
+    factory_group_init();
+    Graph graph;
+    graph.ui.graph = &graph;
+    graph.env.app = nullptr;
+    graph.env.graph = &graph;
+    if (!graph.deserialize(json))
+    {
+        fprintf(stderr, "工程文件解析失败: %s\n", opts->project.c_str());
+        return 2;
+    }
+    graph.build_nodes();
+    graph.env.incremental = opts->incremental;
+    graph.env.use_result_cache = opts->cache;
+    NodeWorldGlobal::fingerprint_values = opts->fingerprint;
+    graph.env.trace_enabled = !opts->trace_path.empty();
+    graph.env.low_memory = opts->low_memory;
+    graph.env.tiled_execution = opts->tile_size > 0;
+    if (opts->tile_size > 0)
+        graph.env.tile_size = opts->tile_size;
+    graph.env.set_worker_count(opts->workers);
+    opencv_parallel::instance().set_policy(opts->cv_policy);
+
+    for (auto &[ref, value] : opts->overrides)
+        if (!set_input(graph, ref, value))
+            return 2;
+
+    if (!opts->export_dir.empty())
+    {
+        auto result = graph.gen_ast_code(opts->export_dir);
+        if (result.has_error())
+        {
+            fprintf(stderr, "导出失败: %s\n", result.Error->Message.c_str());
+            return 1;
+        }
+        printf("已导出到 %s\n", opts->export_dir.c_str());
+        return 0;
+    }
+
+    // 每个输入文件执行一次，没有指定目录时执行一组
+    std::vector<std::string> inputs;
+    if (opts->each)
+    {
+        std::error_code ec;
+        for (auto &entry : std::filesystem::directory_iterator(opts->each->first, ec))
+            if (entry.is_regular_file())
+                inputs.push_back(entry.path().string());
+        if (ec)
+        {
+            fprintf(stderr, "无法读取目录: %s\n", opts->each->first.c_str());
+            return 2;
+        }
+        std::sort(inputs.begin(), inputs.end());
+    }
+    else
+    {
+        inputs.emplace_back();
+    }
+
+    printf("工程: %s 节点: %zu 连线: %zu 工作线程: %zu\n", opts->project.c_str(), graph.Nodes.size(), graph.Links.size(), graph.env.get_worker_count());
+
+    std::vector<double> latencies;
+    size_t failed_runs = 0;
+    auto begin = std::chrono::steady_clock::now();
+    if (opts->each && opts->parallel > 1)
+    {
+        if (!run_contexts(graph, *opts, inputs, latencies, failed_runs))
+            return 2;
+        inputs.clear();
+    }
+    for (auto &input : inputs)
+    {
+        if (opts->each && !set_input(graph, opts->each->second, input))
+            return 2;
+        for (int i = 0; i < opts->repeat; i++)
+        {
+            std::string label = input.empty() ? "" : input + " ";
+            label += "#" + std::to_string(i + 1);
+            auto result = run_once(graph, label, opts->quiet);
+            latencies.push_back(result.ms);
+            if (result.errors > 0)
+                failed_runs++;
+        }
+    }
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    if (!opts->trace_path.empty())
+    {
+        if (graph.env.trace.write(opts->trace_path))
+            printf("执行轨迹: %s, %zu 个事件\n", opts->trace_path.c_str(), graph.env.trace.size());
+        else
+            fprintf(stderr, "无法写入执行轨迹: %s\n", opts->trace_path.c_str());
+    }
+
+    if (latencies.empty())
+    {
+        printf("没有执行\n");
+        graph.env.need_stop();
+        return 0;
+    }
+    std::vector<double> sorted = latencies;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0;
+    for (auto ms : latencies)
+        sum += ms;
+    printf("执行 %zu 次, 出错 %zu 次, 总耗时 %.3f s, 吞吐 %.2f 次/秒\n", latencies.size(), failed_runs, seconds, seconds > 0 ? latencies.size() / seconds : 0.0);
+    printf("延迟 平均 %.3f ms 最小 %.3f ms p50 %.3f ms p95 %.3f ms 最大 %.3f ms\n", sum / latencies.size(), sorted.front(), percentile(sorted, 0.5), percentile(sorted, 0.95), sorted.back());
+    for (auto &resource : graph.env.resources.get_stats())
+        printf("资源 %s: 上限 %d, 执行 %zu 次, 排队 %zu 次, 排队共 %.3f ms, 最长 %.3f ms\n", resource.name.c_str(), resource.limit, resource.acquired, resource.waits, resource.total_wait_ms, resource.max_wait_ms);
+    graph.env.need_stop();
+    return failed_runs > 0 ? 1 : 0;
+}
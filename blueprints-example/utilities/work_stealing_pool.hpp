@@ -0,0 +1,254 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// 工作窃取线程池
+// 每个工作线程持有一个双端队列：自己从队尾取任务（后进先出，缓存友好），
+// 空闲时从其他线程队列的队首窃取任务（先进先出，窃取粒度更大的任务）
+// 工作线程常驻，避免每个节点执行都创建一个新线程
+class work_stealing_pool
+{
+public:
+    using task_t = std::function<void()>;
+
+    explicit work_stealing_pool(size_t worker_count = 0)
+    {
+        start(worker_count);
+    }
+    ~work_stealing_pool()
+    {
+        stop();
+    }
+
+    work_stealing_pool(const work_stealing_pool &) = delete;
+    work_stealing_pool &operator=(const work_stealing_pool &) = delete;
+
+    static size_t default_worker_count()
+    {
+        auto count = std::thread::hardware_concurrency();
+        return count == 0 ? 4 : count;
+    }
+
+    size_t worker_count() const
+    {
+        return active_workers;
+    }
+
+    // 重新设置工作线程数量，会先执行完已经提交的任务
+    // 不能在工作线程中调用，其他线程可以同时提交任务：停止期间提交的任务移入新的队列
+    void resize(size_t worker_count)
+    {
+        stop();
+        start(worker_count);
+    }
+
+    // 提交任务并返回future
+    template <typename F>
+    auto submit(F &&func) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using result_t = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<result_t()>>(std::forward<F>(func));
+        auto future = task->get_future();
+        post([task]()
+             { (*task)(); });
+        return future;
+    }
+
+    // 提交不需要返回值的任务
+    // 在工作线程中提交时放入自己的队列，否则轮流放入各个队列
+    void post(task_t task)
+    {
+        {
+            std::shared_lock<std::shared_mutex> queues_lock(queues_mutex);
+            size_t index = in_worker_thread() ? current_index : next_queue.fetch_add(1) % queues.size();
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            pending++;
+        }
+        wake_cv.notify_one();
+    }
+
+    // 当前线程是否是本线程池的工作线程
+    bool in_worker_thread() const
+    {
+        return current_pool == this;
+    }
+
+    // 当前线程所属的线程池，不是工作线程时为空
+    static work_stealing_pool *current()
+    {
+        return current_pool;
+    }
+
+    // 当前工作线程的序号，不是工作线程时为 0
+    static size_t current_worker_index()
+    {
+        return current_index;
+    }
+
+    // 空闲（没有任务可做、正在睡眠）且不会被已提交任务唤醒的工作线程数量
+    size_t idle_worker_count() const
+    {
+        size_t sleeping = idle, queued = pending;
+        return sleeping > queued ? sleeping - queued : 0;
+    }
+
+    // 等待直到条件满足
+    // 如果在工作线程中等待，则在等待期间帮忙执行其他任务，避免所有工作线程都阻塞造成死锁
+    template <typename Pred>
+    void wait_until(Pred &&done)
+    {
+        if (!in_worker_thread())
+        {
+            while (!done())
+            {
+                std::unique_lock<std::mutex> lock(wake_mutex);
+                wake_cv.wait_for(lock, std::chrono::milliseconds(1));
+            }
+            return;
+        }
+        while (!done())
+        {
+            if (!try_run_one(current_index))
+                std::this_thread::yield();
+        }
+    }
+
+    template <typename T>
+    void wait(std::future<T> &future)
+    {
+        if (!in_worker_thread())
+        {
+            future.wait();
+            return;
+        }
+        wait_until([&future]()
+                   { return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; });
+    }
+
+private:
+    struct task_queue
+    {
+        std::mutex mutex;
+        std::deque<task_t> tasks;
+    };
+
+    void start(size_t worker_count)
+    {
+        if (worker_count == 0)
+            worker_count = default_worker_count();
+        {
+            // 上一批工作线程退出后提交的任务还留在旧的队列中，移入新的队列，已经计入 pending
+            std::unique_lock<std::shared_mutex> queues_lock(queues_mutex);
+            std::vector<std::unique_ptr<task_queue>> next;
+            for (size_t i = 0; i < worker_count; i++)
+                next.push_back(std::make_unique<task_queue>());
+            size_t k = 0;
+            for (auto &queue : queues)
+                for (auto &task : queue->tasks)
+                    next[k++ % worker_count]->tasks.push_back(std::move(task));
+            queues = std::move(next);
+        }
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            stopping = false;
+        }
+        for (size_t i = 0; i < worker_count; i++)
+            workers.emplace_back([this, i]()
+                                 { worker_loop(i); });
+        active_workers = worker_count;
+    }
+
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            stopping = true;
+        }
+        wake_cv.notify_all();
+        for (auto &worker : workers)
+            if (worker.joinable())
+                worker.join();
+        workers.clear();
+    }
+
+    // 从自己队尾取任务，没有则从其他队列队首窃取
+    bool try_run_one(size_t index)
+    {
+        task_t task;
+        std::shared_lock<std::shared_mutex> queues_lock(queues_mutex);
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            if (!queues[index]->tasks.empty())
+            {
+                task = std::move(queues[index]->tasks.back());
+                queues[index]->tasks.pop_back();
+            }
+        }
+        for (size_t i = 1; !task && i < queues.size(); i++)
+        {
+            auto &victim = queues[(index + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim->mutex);
+            if (!victim->tasks.empty())
+            {
+                task = std::move(victim->tasks.front());
+                victim->tasks.pop_front();
+            }
+        }
+        queues_lock.unlock();
+        if (!task)
+            return false;
+        pending--;
+        task();
+        return true;
+    }
+
+    void worker_loop(size_t index)
+    {
+        current_pool = this;
+        current_index = index;
+        while (true)
+        {
+            if (try_run_one(index))
+                continue;
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            idle++;
+            wake_cv.wait(lock, [this]()
+                         { return stopping || pending > 0; });
+            idle--;
+            if (stopping && pending == 0)
+                break;
+        }
+        current_pool = nullptr;
+    }
+
+    // 队列只在重新设置线程数时重建，提交和取任务时共享加锁
+    std::shared_mutex queues_mutex;
+    std::vector<std::unique_ptr<task_queue>> queues;
+    // 工作线程只由构造、析构和 resize 的调用线程访问，其他线程读取 active_workers
+    std::vector<std::thread> workers;
+    std::atomic<size_t> active_workers = 0;
+    std::atomic<size_t> next_queue = 0;
+    std::atomic<size_t> pending = 0;
+    std::atomic<size_t> idle = 0;
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    bool stopping = false;
+
+    inline static thread_local work_stealing_pool *current_pool = nullptr;
+    inline static thread_local size_t current_index = 0;
+};